@@ -0,0 +1,283 @@
+#include "AlphaBeta.hpp"
+
+#include <stdint.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+#include "Zobrist.hpp"
+
+namespace {
+/// 空位上各棋型的分數，依 PatternType 的順序
+constexpr int PATTERN_VALUE[] = {0, 2, 6, 12, 40, 60, 300, 2000};
+}  // namespace
+
+template <int N>
+AlphaBeta<N>::AlphaBeta(size_t tableEntries) {
+    size_t size = 1;
+    while (size * 2 <= tableEntries) size *= 2;
+    table.resize(size);
+    tableMask = size - 1;
+    memset(history, 0, sizeof(history));
+}
+
+template <int N>
+Position AlphaBeta<N>::search(const Node<N>* node, int timeLimit) {
+    load(node);
+    deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeLimit);
+    stopped = false;
+    nodes = 0;
+    depth = 0;
+    score = 0;
+    // history 跨回合保留但逐回合衰減，killer 只對同一棵樹有意義
+    for (int side = 0; side < 2; side++) {
+        for (int pos = 0; pos < Board<N>::CELLS; pos++) {
+            history[side][pos] /= 2;
+        }
+    }
+    for (int ply = 0; ply < MAX_PLY; ply++) {
+        killers[ply][0] = killers[ply][1] = -1;
+    }
+
+    const bool isBlack = !node->isBlackTurn;
+    const int me = isBlack ? 0 : 1;
+    int moves[Board<N>::CELLS];
+    // 自己能連五就直接下；對手也有連五點時 generateMoves 只回傳擋點，所以要掃過所有空位
+    if (fives[me] > 0) {
+        for (int pos = 0; pos < Board<N>::CELLS; pos++) {
+            for (int direction = 0; direction < DIRECTION_COUNT; direction++) {
+                if (patterns[me][direction][pos] == PATTERN_FIVE) {
+                    return Board<N>::LOOKUP_TABLE[pos];
+                }
+            }
+        }
+    }
+    int count = generateMoves(isBlack, 0, -1, moves);
+    if (count == 0) {
+        return {N / 2, N / 2};  // 空棋盤下天元
+    }
+    // 時間不夠搜完深度 1 時退回排序最前面的候選點
+    int best = moves[0];
+    rootMove = -1;
+    for (int iteration = 1; iteration <= MAX_DEPTH; iteration++) {
+        int value = negamax(isBlack, iteration, 0, -INFINITE_SCORE, INFINITE_SCORE);
+        if (stopped) {
+            break;
+        }
+        if (rootMove >= 0) {
+            best = rootMove;  // 根節點在設定 rootMove 前就以勝負截斷時沿用先前的著手
+        }
+        depth = iteration;
+        score = value;
+        if (abs(value) >= WIN_THRESHOLD) {
+            break;  // 勝負已定，再加深也不會改變結果
+        }
+    }
+    return Board<N>::LOOKUP_TABLE[best];
+}
+
+template <int N>
+void AlphaBeta<N>::load(const Node<N>* node) {
+    memcpy(boardBlack, node->boardBlack, sizeof(boardBlack));
+    memcpy(boardWhite, node->boardWhite, sizeof(boardWhite));
+    lineBoard.load(boardBlack, boardWhite);
+    hash = node->hash;
+    memset(patterns, 0, sizeof(patterns));
+    memset(cellValue, 0, sizeof(cellValue));
+    memset(total, 0, sizeof(total));
+    memset(fives, 0, sizeof(fives));
+    for (int pos = 0; pos < Board<N>::CELLS; pos++) {
+        if (getBit(boardBlack, pos) || getBit(boardWhite, pos)) continue;
+        for (int side = 0; side < 2; side++) {
+            for (int direction = 0; direction < DIRECTION_COUNT; direction++) {
+                PatternType pattern = patternAt(lineBoard, pos, direction, side == 0);
+                patterns[side][direction][pos] = pattern;
+                cellValue[side][pos] += PATTERN_VALUE[pattern];
+                total[side] += PATTERN_VALUE[pattern];
+                fives[side] += pattern == PATTERN_FIVE;
+            }
+        }
+    }
+}
+
+template <int N>
+void AlphaBeta<N>::place(int pos, bool isBlack) {
+    setBit(isBlack ? boardBlack : boardWhite, pos);
+    lineBoard.place(pos, isBlack);
+    hash ^= zobristKey<N>(pos, isBlack);
+    refresh(pos);
+}
+
+template <int N>
+void AlphaBeta<N>::remove(int pos, bool isBlack) {
+    uint64_t* board = isBlack ? boardBlack : boardWhite;
+    board[pos >> 6] &= ~(1ULL << (pos & 63));
+    lineBoard.remove(pos, isBlack);
+    hash ^= zobristKey<N>(pos, isBlack);
+    refresh(pos);
+}
+
+template <int N>
+void AlphaBeta<N>::refresh(int pos) {
+    Position center = Board<N>::LOOKUP_TABLE[pos];
+    for (int direction = 0; direction < DIRECTION_COUNT; direction++) {
+        for (int k = -4; k <= 4; k++) {
+            int x = center.x + k * DIRECTION[direction].x, y = center.y + k * DIRECTION[direction].y;
+            if (x < 0 || x >= N || y < 0 || y >= N) continue;
+            int cell = x * N + y;
+            bool occupied = getBit(boardBlack, cell) || getBit(boardWhite, cell);
+            for (int side = 0; side < 2; side++) {
+                // 其他方向的線沒有變，只需要重查這個方向
+                PatternType pattern = occupied ? PATTERN_NONE : patternAt(lineBoard, cell, direction, side == 0);
+                uint8_t& old = patterns[side][direction][cell];
+                if (pattern == old) continue;
+                int delta = PATTERN_VALUE[pattern] - PATTERN_VALUE[old];
+                cellValue[side][cell] += delta;
+                total[side] += delta;
+                fives[side] += (pattern == PATTERN_FIVE) - (old == PATTERN_FIVE);
+                old = pattern;
+            }
+        }
+    }
+}
+
+template <int N>
+int AlphaBeta<N>::evaluate(bool isBlack) const {
+    const int me = isBlack ? 0 : 1;
+    // 輪到的一方可以先實現自己的威脅，分數打個折扣給對手
+    return total[me] - total[1 - me] * 3 / 4;
+}
+
+template <int N>
+int AlphaBeta<N>::generateMoves(bool isBlack, int ply, int tableMove, int* moves) const {
+    const int me = isBlack ? 0 : 1, opponent = 1 - me;
+    uint64_t neighbours[BITBOARD_COUNT];
+    Board<N>::emptyNeighbours(boardBlack, boardWhite, neighbours);
+    int count = 0;
+    int priority[Board<N>::CELLS];
+    Board<N>::forEachBit(neighbours, [&](int pos) {
+        if (fives[opponent] > 0) {
+            // 對手有連五點時只能擋
+            bool block = false;
+            for (int direction = 0; direction < DIRECTION_COUNT; direction++) {
+                block |= patterns[opponent][direction][pos] == PATTERN_FIVE;
+            }
+            if (!block) return;
+        }
+        int value = cellValue[me][pos] * 2 + cellValue[opponent][pos] + history[me][pos];
+        if (pos == tableMove) {
+            value += 1 << 30;
+        } else if (pos == killers[ply][0] || pos == killers[ply][1]) {
+            value += 1 << 28;
+        }
+        moves[count] = pos;
+        priority[count++] = value;
+    });
+    // 只需要前 MAX_CANDIDATES 名，選擇排序即可
+    const int limit = count < MAX_CANDIDATES ? count : MAX_CANDIDATES;
+    for (int i = 0; i < limit; i++) {
+        int best = i;
+        for (int j = i + 1; j < count; j++) {
+            if (priority[j] > priority[best]) best = j;
+        }
+        std::swap(moves[i], moves[best]);
+        std::swap(priority[i], priority[best]);
+    }
+    return limit;
+}
+
+template <int N>
+int AlphaBeta<N>::negamax(bool isBlack, int remaining, int ply, int alpha, int beta) {
+    if ((++nodes & 1023) == 0 && std::chrono::steady_clock::now() >= deadline) {
+        stopped = true;
+    }
+    if (stopped) {
+        return 0;
+    }
+    const int me = isBlack ? 0 : 1;
+    if (fives[me] > 0) {
+        return WIN_SCORE - ply;  // 輪到的一方直接連五
+    }
+    if (remaining == 0 || ply >= MAX_PLY - 1) {
+        return evaluate(isBlack);
+    }
+
+    // 置換表中的勝負分數以「距離該局面的步數」保存，讀寫時換算成距離根節點的步數
+    TableEntry& entry = table[hash & tableMask];
+    int tableMove = -1;
+    if (entry.key == hash) {
+        tableMove = entry.move;
+        int stored = entry.score;
+        if (stored >= WIN_THRESHOLD) {
+            stored -= ply;
+        } else if (stored <= -WIN_THRESHOLD) {
+            stored += ply;
+        }
+        if (ply > 0 && entry.depth >= remaining &&
+            (entry.bound == EXACT || (entry.bound == LOWER && stored >= beta) ||
+             (entry.bound == UPPER && stored <= alpha))) {
+            return stored;
+        }
+    }
+
+    int moves[Board<N>::CELLS];
+    int count = generateMoves(isBlack, ply, tableMove, moves);
+    if (count == 0) {
+        return 0;  // 棋盤下滿，平手
+    }
+    const int originalAlpha = alpha;
+    int best = -INFINITE_SCORE, bestMove = moves[0];
+    for (int i = 0; i < count; i++) {
+        place(moves[i], isBlack);
+        int value;
+        if (i == 0) {
+            value = -negamax(!isBlack, remaining - 1, ply + 1, -beta, -alpha);
+        } else {
+            // 其餘著手先以零寬度視窗驗證不會比主變例好，失敗才重搜
+            value = -negamax(!isBlack, remaining - 1, ply + 1, -alpha - 1, -alpha);
+            if (value > alpha && value < beta) {
+                value = -negamax(!isBlack, remaining - 1, ply + 1, -beta, -alpha);
+            }
+        }
+        remove(moves[i], isBlack);
+        if (stopped) {
+            return 0;
+        }
+        if (value > best) {
+            best = value;
+            bestMove = moves[i];
+        }
+        if (value > alpha) {
+            alpha = value;
+        }
+        if (alpha >= beta) {
+            if (killers[ply][0] != moves[i]) {
+                killers[ply][1] = killers[ply][0];
+                killers[ply][0] = moves[i];
+            }
+            history[me][moves[i]] += remaining * remaining;
+            break;
+        }
+    }
+    if (ply == 0) {
+        rootMove = bestMove;
+    }
+
+    int stored = best;
+    if (stored >= WIN_THRESHOLD) {
+        stored += ply;
+    } else if (stored <= -WIN_THRESHOLD) {
+        stored -= ply;
+    }
+    entry.key = hash;
+    entry.score = stored;
+    entry.move = static_cast<int16_t>(bestMove);
+    entry.depth = static_cast<int8_t>(remaining);
+    entry.bound = best <= originalAlpha ? UPPER : best >= beta ? LOWER : EXACT;
+    return best;
+}
+
+template class AlphaBeta<9>;
+template class AlphaBeta<15>;
+template class AlphaBeta<19>;
@@ -0,0 +1,107 @@
+#ifndef ALPHABETA_HPP
+#define ALPHABETA_HPP
+
+#include <stdint.h>
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+#include "Bitboard.hpp"
+#include "LineBoard.hpp"
+#include "Node.hpp"
+#include "Pattern.hpp"
+
+/**
+ * @brief 以 PVS (principal variation search) 與迭代加深實作的 alpha-beta 引擎，可在開局時取代 MCTS
+ *
+ * - 評估函式：每個空位在四個方向上對雙方的棋型（查 Pattern 表）依分數加總。落子或撤銷時只重算
+ *   通過該格的四條線上前後各四格，所以評估值是增量維護的，葉節點評估只是兩個整數相減。
+ * - 候選點沿用 MCTS 展開的概念，只考慮與棋子相鄰的空位；依棋型分數、置換表著手、killer 與 history
+ *   排序後只展開前 MAX_CANDIDATES 個。對手有連五點時只考慮擋住它。
+ * - 置換表以 Zobrist 雜湊為索引，跨回合保留。
+ *
+ * 樣板只在 AlphaBeta.cpp 中對支援的棋盤大小（9、15、19）明確實例化。
+ */
+template <int N>
+class AlphaBeta {
+   public:
+    static constexpr int MAX_DEPTH = 32;       ///< 迭代加深的最大深度
+    static constexpr int MAX_CANDIDATES = 16;  ///< 每層最多展開的候選點數量
+    static constexpr size_t DEFAULT_TABLE_ENTRIES = 1 << 20;
+    static constexpr int WIN_SCORE = 1000000;  ///< 連五的分數，減去步數讓較快的勝利分數較高
+
+    explicit AlphaBeta(size_t tableEntries = DEFAULT_TABLE_ENTRIES);
+
+    /**
+     * @brief 在 timeLimit 毫秒內找出輪到的一方（落下 node->lastMove 的另一方）的最佳著手
+     *
+     * 從深度 1 開始逐層加深，時間用完時回傳最後一個完整搜完的深度的結果；找到必勝或必敗時提早結束。
+     */
+    Position search(const Node<N>* node, int timeLimit);
+
+    /// @brief 最近一次 search 完整搜完的深度
+    int completedDepth() const { return depth; }
+    /// @brief 最近一次 search 完整搜完的深度的分數（輪到的一方的觀點）
+    int lastScore() const { return score; }
+    /// @brief 最近一次 search 走訪的節點數
+    size_t nodesSearched() const { return nodes; }
+
+   private:
+    static constexpr int BITBOARD_COUNT = Board<N>::BITBOARD_COUNT;
+    static constexpr int MAX_PLY = MAX_DEPTH + 1;
+    static constexpr int INFINITE_SCORE = WIN_SCORE + 1;
+    static constexpr int WIN_THRESHOLD = WIN_SCORE - MAX_PLY;  ///< 絕對值超過它的分數代表勝負已定
+    /// 四個方向的單位位移，與 LineBoard 的方向順序相同
+    static constexpr Position DIRECTION[DIRECTION_COUNT] = {{0, 1}, {1, 0}, {1, 1}, {1, -1}};
+
+    enum Bound : uint8_t { EXACT = 0, LOWER = 1, UPPER = 2 };
+
+    struct TableEntry {
+        uint64_t key = 0;
+        int32_t score = 0;
+        int16_t move = -1;
+        int8_t depth = -1;
+        uint8_t bound = EXACT;
+    };
+
+    std::vector<TableEntry> table;
+    size_t tableMask;
+
+    uint64_t boardBlack[BITBOARD_COUNT];
+    uint64_t boardWhite[BITBOARD_COUNT];
+    LineBoard<N> lineBoard;
+    uint64_t hash = 0;
+    /// 每個空位在各方向上對黑（[0]）、白（[1]）的棋型，有棋子的格子為 PATTERN_NONE
+    uint8_t patterns[2][DIRECTION_COUNT][Board<N>::CELLS];
+    int cellValue[2][Board<N>::CELLS];  ///< 每個空位四個方向的棋型分數總和，用於排序
+    int total[2];                       ///< 全盤棋型分數總和，用於評估
+    int fives[2];                       ///< 連五點（格子、方向）的數量
+
+    int killers[MAX_PLY][2];
+    int history[2][Board<N>::CELLS];
+    std::chrono::steady_clock::time_point deadline;
+    bool stopped = false;
+    size_t nodes = 0;
+    int rootMove = -1;
+    int depth = 0;
+    int score = 0;
+
+    void load(const Node<N>* node);
+    void place(int pos, bool isBlack);
+    void remove(int pos, bool isBlack);
+    /// @brief 重新計算通過 pos 的四條線上前後各四格的棋型，並更新分數
+    void refresh(int pos);
+    int evaluate(bool isBlack) const;
+    /**
+     * @brief 產生候選點並依排序分數由高到低排列，回傳數量（最多 MAX_CANDIDATES）
+     */
+    int generateMoves(bool isBlack, int ply, int tableMove, int* moves) const;
+    int negamax(bool isBlack, int remaining, int ply, int alpha, int beta);
+};
+
+extern template class AlphaBeta<9>;
+extern template class AlphaBeta<15>;
+extern template class AlphaBeta<19>;
+
+#endif  // ALPHABETA_HPP
@@ -0,0 +1,203 @@
+#include "BatchPlayout.hpp"
+
+#include <stdint.h>
+
+#include "Bitboard.hpp"
+#include "Instrument.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define BATCH_PLAYOUT_AVX2 1
+#include <immintrin.h>
+#endif
+
+#ifdef BATCH_PLAYOUT_AVX2
+namespace {
+
+constexpr int MAX_DEEP = 50;  ///< 與純量 playout 相同的最大模擬深度，超過視為平手
+
+/**
+ * @brief 五連起點遮罩：從該格往 (dx, dy) 方向數五格仍在棋盤內的格子
+ */
+template <int N>
+constexpr BitboardMask<N> createFiveStartMask(int dx, int dy) {
+    BitboardMask<N> mask{};
+    for (int x = 0; x < N; x++) {
+        for (int y = 0; y < N; y++) {
+            int endX = x + 4 * dx, endY = y + 4 * dy;
+            if (endX < 0 || endX >= N || endY < 0 || endY >= N) continue;
+            int pos = x * N + y;
+            mask[pos >> 6] |= 1ULL << (pos & 63);
+        }
+    }
+    return mask;
+}
+
+/// @brief N x N 棋盤四個方向的五連起點遮罩
+template <int N>
+struct FiveStart {
+    static constexpr BitboardMask<N> HORIZONTAL = createFiveStartMask<N>(0, 1);
+    static constexpr BitboardMask<N> VERTICAL = createFiveStartMask<N>(1, 0);
+    static constexpr BitboardMask<N> DIAGONAL = createFiveStartMask<N>(1, 1);
+    static constexpr BitboardMask<N> ANTI_DIAGONAL = createFiveStartMask<N>(1, -1);
+};
+
+/// 垂直與斜向的最大位移 3 (N + 1) 必須小於 64，每次位移才只跨一個字組
+template <int N>
+constexpr bool AVX2_SUPPORTED_SIZE = 3 * (N + 1) < 64;
+
+/**
+ * @brief SoA 位棋盤（每個字組一個暫存器、每個 lane 一局）整盤往低位移動 SHIFT 個 bit 後的第 word 個字組
+ */
+template <int N, int SHIFT>
+__attribute__((target("avx2"))) inline __m256i shiftedWord(const __m256i* board, int word) {
+    static_assert(SHIFT > 0 && SHIFT < 64, "位移量必須落在單一字組內");
+    __m256i low = _mm256_srli_epi64(board[word], SHIFT);
+    if (word == Board<N>::BITBOARD_COUNT - 1) {
+        return low;
+    }
+    return _mm256_or_si256(low, _mm256_slli_epi64(board[word + 1], 64 - SHIFT));
+}
+
+/**
+ * @brief 把 STEP 方向上的五連起點 OR 進 found
+ *
+ * pairs(p) = b(p) & b(p + STEP)，五連 = pairs(p) & pairs(p + 2 STEP) & pairs(p + 3 STEP)，
+ * 最大位移 3 STEP 小於 64（見 AVX2_SUPPORTED_SIZE），每次位移都只跨一個字組。
+ */
+template <int N, int STEP>
+__attribute__((target("avx2"))) inline void findFives(const __m256i* board, const BitboardMask<N>& start,
+                                                      __m256i* found) {
+    constexpr int BITBOARD_COUNT = Board<N>::BITBOARD_COUNT;
+    __m256i pairs[BITBOARD_COUNT];
+    for (int w = 0; w < BITBOARD_COUNT; w++) {
+        pairs[w] = _mm256_and_si256(board[w], shiftedWord<N, STEP>(board, w));
+    }
+    for (int w = 0; w < BITBOARD_COUNT; w++) {
+        __m256i five = _mm256_and_si256(pairs[w], shiftedWord<N, 2 * STEP>(pairs, w));
+        five = _mm256_and_si256(five, shiftedWord<N, 3 * STEP>(pairs, w));
+        five = _mm256_and_si256(five, _mm256_set1_epi64x(start[w]));
+        found[w] = _mm256_or_si256(found[w], five);
+    }
+}
+
+/**
+ * @brief 回傳有五連的 lane（bit i 對應第 i 局）
+ */
+template <int N>
+__attribute__((target("avx2"))) inline int lanesWithFive(const __m256i* board) {
+    constexpr int BITBOARD_COUNT = Board<N>::BITBOARD_COUNT;
+    __m256i found[BITBOARD_COUNT];
+    for (int w = 0; w < BITBOARD_COUNT; w++) {
+        found[w] = _mm256_setzero_si256();
+    }
+    findFives<N, 1>(board, FiveStart<N>::HORIZONTAL, found);
+    findFives<N, N>(board, FiveStart<N>::VERTICAL, found);
+    findFives<N, N + 1>(board, FiveStart<N>::DIAGONAL, found);
+    findFives<N, N - 1>(board, FiveStart<N>::ANTI_DIAGONAL, found);
+    __m256i any = found[0];
+    for (int w = 1; w < BITBOARD_COUNT; w++) {
+        any = _mm256_or_si256(any, found[w]);
+    }
+    int empty = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(any, _mm256_setzero_si256())));
+    return ~empty & 0xF;
+}
+
+/**
+ * @brief AVX2 版本：四局的棋盤以 SoA 放在暫存器中同步推進
+ *
+ * 每一步四局都是同一方落子：各 lane 以自己的亂數流從候選位棋盤中均勻抽一個空位（BMI2 pdep 取第 k 個 bit），
+ * 之後落子、候選更新與整盤五連判斷都以向量運算一次處理四局。已結束的 lane 落子遮罩為 0，棋盤不再變動。
+ */
+template <int N>
+__attribute__((target("avx2,bmi2"))) int avx2RandomPlayouts(const Node<N>* node, PlayoutRng* rngs, int count) {
+    constexpr int BITBOARD_COUNT = Board<N>::BITBOARD_COUNT;
+    const bool startTurn = node->isBlackTurn;
+    __m256i boards[2][BITBOARD_COUNT];  // [0] = 黑, [1] = 白
+    __m256i candidates[BITBOARD_COUNT];
+    uint64_t initialCandidates[BITBOARD_COUNT];
+    Board<N>::emptyNeighbours(node->boardBlack, node->boardWhite, initialCandidates);
+    for (int w = 0; w < BITBOARD_COUNT; w++) {
+        boards[0][w] = _mm256_set1_epi64x(node->boardBlack[w] & Board<N>::VALID_MASK[w]);
+        boards[1][w] = _mm256_set1_epi64x(node->boardWhite[w] & Board<N>::VALID_MASK[w]);
+        candidates[w] = _mm256_set1_epi64x(initialCandidates[w]);
+    }
+
+    alignas(32) uint64_t candidateWords[BITBOARD_COUNT][PLAYOUT_BATCH];
+    alignas(32) uint64_t moveWords[BITBOARD_COUNT][PLAYOUT_BATCH];
+    alignas(32) uint64_t neighbourWords[BITBOARD_COUNT][PLAYOUT_BATCH];
+    int active = (1 << count) - 1;
+    int total = 0;
+    bool currentTurn = startTurn;
+    for (int step = 0; step < MAX_DEEP && active; step++) {
+        currentTurn = !currentTurn;
+        for (int w = 0; w < BITBOARD_COUNT; w++) {
+            _mm256_store_si256(reinterpret_cast<__m256i*>(candidateWords[w]), candidates[w]);
+        }
+        // 各 lane 抽出自己的落點，沒有候選點的 lane 以平手結束
+        for (int lane = 0; lane < PLAYOUT_BATCH; lane++) {
+            for (int w = 0; w < BITBOARD_COUNT; w++) {
+                moveWords[w][lane] = 0;
+                neighbourWords[w][lane] = 0;
+            }
+            if (!(active & (1 << lane))) continue;
+            int counts[BITBOARD_COUNT], moveCount = 0;
+            for (int w = 0; w < BITBOARD_COUNT; w++) {
+                counts[w] = __builtin_popcountll(candidateWords[w][lane]);
+                moveCount += counts[w];
+            }
+            if (moveCount == 0) {
+                active &= ~(1 << lane);
+                continue;
+            }
+            // 以乘法取代除法把 32 bit 亂數映到 [0, moveCount)
+            int k = static_cast<int>(((rngs[lane]() >> 32) * moveCount) >> 32);
+            int w = 0;
+            while (k >= counts[w]) {
+                k -= counts[w++];
+            }
+            int bit = __builtin_ctzll(_pdep_u64(1ULL << k, candidateWords[w][lane]));
+            int pos = w * 64 + bit;
+            moveWords[w][lane] = 1ULL << bit;
+            for (int i = 0; i < BITBOARD_COUNT; i++) {
+                neighbourWords[i][lane] = Board<N>::NEIGHBOUR_TABLE[pos][i];
+            }
+        }
+        INSTRUMENT_ADD(playoutMoves, __builtin_popcount(active));
+
+        __m256i* own = boards[currentTurn ? 0 : 1];
+        for (int w = 0; w < BITBOARD_COUNT; w++) {
+            own[w] = _mm256_or_si256(own[w], _mm256_load_si256(reinterpret_cast<const __m256i*>(moveWords[w])));
+        }
+        int winners = lanesWithFive<N>(own) & active;
+        if (winners) {
+            total += __builtin_popcount(winners) * ((currentTurn == startTurn) ? 1 : -1);
+            active &= ~winners;
+        }
+        for (int w = 0; w < BITBOARD_COUNT; w++) {
+            __m256i occupied = _mm256_or_si256(boards[0][w], boards[1][w]);
+            __m256i added = _mm256_load_si256(reinterpret_cast<const __m256i*>(neighbourWords[w]));
+            candidates[w] = _mm256_andnot_si256(occupied, _mm256_or_si256(candidates[w], added));
+        }
+    }
+    return total;
+}
+
+}  // namespace
+#endif  // BATCH_PLAYOUT_AVX2
+
+template <int N>
+BatchPlayoutKernel<N> batchPlayoutKernel() {
+#ifdef BATCH_PLAYOUT_AVX2
+    static const bool supported = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi2");
+    if constexpr (AVX2_SUPPORTED_SIZE<N>) {
+        if (supported) {
+            return &avx2RandomPlayouts<N>;
+        }
+    }
+#endif
+    return nullptr;
+}
+
+template BatchPlayoutKernel<9> batchPlayoutKernel<9>();
+template BatchPlayoutKernel<15> batchPlayoutKernel<15>();
+template BatchPlayoutKernel<19> batchPlayoutKernel<19>();
@@ -0,0 +1,29 @@
+#ifndef BATCHPLAYOUT_HPP
+#define BATCHPLAYOUT_HPP
+
+#include "Node.hpp"
+#include "Random.hpp"
+
+constexpr int PLAYOUT_BATCH = 4;  ///< 一次同步推進的 playout 數（一個 256 bit 暫存器放四個 64 bit 字組）
+
+/**
+ * @brief 從同一個節點同時跑 count 局隨機 playout 的 kernel
+ *
+ * @param node playout 的起點
+ * @param rngs 每一局各自的亂數流（至少 count 個）
+ * @param count 局數，1 ~ PLAYOUT_BATCH
+ * @return int 各局結果的總和（以 node 剛落子的一方為準，勝 +1、負 -1、和 0）
+ */
+template <int N>
+using BatchPlayoutKernel = int (*)(const Node<N>* node, PlayoutRng* rngs, int count);
+
+/**
+ * @brief 依執行時的 CPU 支援選擇批次 kernel
+ *
+ * 目前只有 x86 上的 AVX2 + BMI2 版本；不支援時回傳 nullptr，呼叫端改為逐局執行純量 playout。
+ * 只在 BatchPlayout.cpp 中對支援的棋盤大小（9、15、19）明確實例化。
+ */
+template <int N>
+BatchPlayoutKernel<N> batchPlayoutKernel();
+
+#endif  // BATCHPLAYOUT_HPP
@@ -0,0 +1,184 @@
+#ifndef BITBOARD_HPP
+#define BITBOARD_HPP
+
+#include <stdint.h>
+
+#include <array>
+
+#include "Game.hpp"
+using std::array;
+
+struct Position {
+    int x;
+    int y;
+};
+
+inline void setBit(uint64_t* bitboard, int pos) { bitboard[pos >> 6] |= 1ULL << (pos & 63); }
+inline bool getBit(const uint64_t* bitboard, int pos) { return bitboard[pos >> 6] & (1ULL << (pos & 63)); }
+
+// ---------------------------------------------------------------------------
+// 以棋盤大小為樣板參數的位棋盤
+//
+// 棋盤第 x 列第 y 行的格子對應第 x * N + y 個 bit。往右一格是 +1，往下一格是 +N，
+// 所以相鄰格子就是整個位棋盤左移或右移 1、N-1、N、N+1 個 bit。
+// 水平方向的位移會讓最右（左）一行繞到下一列的最左（右）一行，因此位移前要先遮掉該行；
+// 最後一個字組中超出棋盤的 padding bit 一律以 VALID_MASK 去除。
+// 所有遮罩與查表都在編譯期依 N 產生，每種棋盤大小各自得到完全特化的程式碼。
+// ---------------------------------------------------------------------------
+
+/// 表示 size x size 棋盤需要的 uint64_t 數量
+constexpr int bitboardCount(int size) { return (size * size + 63) / 64; }
+
+template <int N>
+using BitboardMask = std::array<uint64_t, bitboardCount(N)>;
+
+template <int N>
+constexpr BitboardMask<N> createValidMask() {
+    BitboardMask<N> mask{};
+    for (int pos = 0; pos < N * N; pos++) {
+        mask[pos >> 6] |= 1ULL << (pos & 63);
+    }
+    return mask;
+}
+
+template <int N>
+constexpr BitboardMask<N> createColumnMask(int column) {
+    BitboardMask<N> mask{};
+    for (int row = 0; row < N; row++) {
+        int pos = row * N + column;
+        mask[pos >> 6] |= 1ULL << (pos & 63);
+    }
+    return mask;
+}
+
+template <int N>
+constexpr std::array<BitboardMask<N>, N * N> createNeighbourTable() {
+    std::array<BitboardMask<N>, N * N> table{};
+    for (int pos = 0; pos < N * N; pos++) {
+        int x = pos / N, y = pos % N;
+        for (int dx = -1; dx <= 1; dx++) {
+            for (int dy = -1; dy <= 1; dy++) {
+                int nx = x + dx, ny = y + dy;
+                if ((dx == 0 && dy == 0) || nx < 0 || nx >= N || ny < 0 || ny >= N) continue;
+                int neighbour = nx * N + ny;
+                table[pos][neighbour >> 6] |= 1ULL << (neighbour & 63);
+            }
+        }
+    }
+    return table;
+}
+
+template <int N>
+constexpr std::array<Position, N * N> createLookupTable() {
+    std::array<Position, N * N> table{};
+    for (int index = 0; index < N * N; ++index) {
+        table[index].x = index / N;
+        table[index].y = index % N;
+    }
+    return table;
+}
+
+/**
+ * @brief N x N 棋盤的常數、遮罩、查表與整盤位運算
+ */
+template <int N>
+struct Board {
+    static_assert(N >= 5, "棋盤至少要放得下五連");
+
+    static constexpr int SIZE = N;                          ///< 邊長
+    static constexpr int CELLS = N * N;                     ///< 格子數，也是每個節點最多的子節點數量
+    static constexpr int BITBOARD_COUNT = bitboardCount(N);  ///< 位棋盤的字組數
+    using Mask = BitboardMask<N>;
+
+    /// 最後一個字組中不屬於棋盤的 padding bit（15x15 時為 0xFFFFFFFE00000000）
+    static constexpr uint64_t PADDING_MASK = CELLS % 64 == 0 ? 0 : ~0ULL << (CELLS % 64);
+    static constexpr Mask VALID_MASK = createValidMask<N>();                ///< 棋盤上所有格子
+    static constexpr Mask FIRST_COLUMN_MASK = createColumnMask<N>(0);       ///< 最左一行
+    static constexpr Mask LAST_COLUMN_MASK = createColumnMask<N>(N - 1);    ///< 最右一行
+    /// 每個格子的八個相鄰格子，用於落子後增量更新候選位置
+    static constexpr std::array<Mask, CELLS> NEIGHBOUR_TABLE = createNeighbourTable<N>();
+    /// 格子索引對應的座標
+    static constexpr std::array<Position, CELLS> LOOKUP_TABLE = createLookupTable<N>();
+
+    static constexpr int index(Position position) { return position.x * N + position.y; }
+    static void setBit(uint64_t* bitboard, Position position) { ::setBit(bitboard, index(position)); }
+    static bool getBit(const uint64_t* bitboard, Position position) { return ::getBit(bitboard, index(position)); }
+
+    /**
+     * @brief 整個位棋盤往高位移動 shift 個 bit（0 < shift < 64）
+     */
+    static void shiftUp(const uint64_t* in, uint64_t* out, int shift) {
+        for (int i = BITBOARD_COUNT - 1; i > 0; i--) {
+            out[i] = (in[i] << shift) | (in[i - 1] >> (64 - shift));
+        }
+        out[0] = in[0] << shift;
+    }
+
+    /**
+     * @brief 整個位棋盤往低位移動 shift 個 bit（0 < shift < 64）
+     */
+    static void shiftDown(const uint64_t* in, uint64_t* out, int shift) {
+        for (int i = 0; i < BITBOARD_COUNT - 1; i++) {
+            out[i] = (in[i] >> shift) | (in[i + 1] << (64 - shift));
+        }
+        out[BITBOARD_COUNT - 1] = in[BITBOARD_COUNT - 1] >> shift;
+    }
+
+    /**
+     * @brief 八方向膨脹：結果包含原本的棋子以及所有相鄰格子
+     *
+     * 先做水平膨脹（遮掉邊界行避免換列），再對結果做垂直膨脹，四次整盤位移即可涵蓋八個方向。
+     */
+    static void dilate(const uint64_t* stones, uint64_t* out) {
+        uint64_t left[BITBOARD_COUNT], right[BITBOARD_COUNT], horizontal[BITBOARD_COUNT];
+        for (int i = 0; i < BITBOARD_COUNT; i++) {
+            left[i] = stones[i] & ~FIRST_COLUMN_MASK[i];
+            right[i] = stones[i] & ~LAST_COLUMN_MASK[i];
+        }
+        shiftDown(left, left, 1);
+        shiftUp(right, right, 1);
+        for (int i = 0; i < BITBOARD_COUNT; i++) {
+            horizontal[i] = stones[i] | left[i] | right[i];
+        }
+        uint64_t up[BITBOARD_COUNT], down[BITBOARD_COUNT];
+        shiftUp(horizontal, up, N);
+        shiftDown(horizontal, down, N);
+        for (int i = 0; i < BITBOARD_COUNT; i++) {
+            out[i] = (horizontal[i] | up[i] | down[i]) & VALID_MASK[i];
+        }
+    }
+
+    /**
+     * @brief 計算所有與棋子相鄰的空位（走子候選的邊界）
+     *
+     * @param boardBlack 黑棋位棋盤（padding bit 可為任意值）
+     * @param boardWhite 白棋位棋盤（padding bit 可為任意值）
+     * @param out 相鄰空位的位棋盤
+     */
+    static void emptyNeighbours(const uint64_t* boardBlack, const uint64_t* boardWhite, uint64_t* out) {
+        uint64_t occupied[BITBOARD_COUNT];
+        for (int i = 0; i < BITBOARD_COUNT; i++) {
+            occupied[i] = (boardBlack[i] | boardWhite[i]) & VALID_MASK[i];
+        }
+        dilate(occupied, out);
+        for (int i = 0; i < BITBOARD_COUNT; i++) {
+            out[i] &= ~occupied[i];
+        }
+    }
+
+    /**
+     * @brief 依序取出位棋盤中每個為 1 的 bit，對其全域位置呼叫 visit
+     */
+    template <class Visitor>
+    static void forEachBit(const uint64_t* bitboard, Visitor&& visit) {
+        for (int i = 0; i < BITBOARD_COUNT; i++) {
+            uint64_t bits = bitboard[i];
+            while (bits) {
+                visit(__builtin_ctzll(bits) + i * 64);
+                bits &= bits - 1;  // 清除最低位的 1
+            }
+        }
+    }
+};
+
+#endif  // BITBOARD_HPP
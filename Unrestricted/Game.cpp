@@ -2,11 +2,16 @@
 
 #include <stdint.h>
 
+#include <cstring>
 #include <iomanip>
 #include <iostream>
+#include <thread>
 
+#include "AlphaBeta.hpp"
 #include "MCTS.hpp"
 #include "Node.hpp"
+#include "OpeningBook.hpp"
+#include "ThreatSearch.hpp"
 #define RED "\033[31;1m"      // 亮紅色
 #define GREEN "\033[32;1m"    // 亮綠色
 #define YELLOW "\033[33;1m"   // 亮黃色
@@ -18,45 +23,113 @@
 // Function declaration for expansion
 
 using namespace std;
-void Game::startGame() {
-    Node* root = new Node();
-    // generateFullTree(root);
-    Node* currentNode = root;  // CurrentNode為當前棋盤最後一個子的節點，會去選擇他的子節點來下棋
-    int playerOrder, currentOrder = 0, aiMode, iterationTimes, simulationTimes;
+template <int N>
+void Game<N>::startGame() {
+    int playerOrder, currentOrder = 0, aiMode, iterationTimes, timeLimit, simulationTimes, parallelMode, policy, pondering;
+    int engine;
     cout << "Input stimulation times." << endl;
     cin >> simulationTimes;
-    MCTS ai(simulationTimes, 6);
+    cout << "Choose search mode: 1 = leaf parallel, 2 = tree parallel, 3 = root parallel" << endl;
+    while (true) {
+        cin >> parallelMode;
+        if (parallelMode >= searchMode::LEAF_PARALLEL && parallelMode <= searchMode::ROOT_PARALLEL) {
+            break;
+        }
+        cout << "Please input 1, 2 or 3" << endl;
+    }
+    // 葉平行受限於全域執行緒池的大小；樹平行與根平行則每個核心各跑一個 worker
+    int threadCount = parallelMode == searchMode::LEAF_PARALLEL ? 6 : max(1u, thread::hardware_concurrency());
+    MCTS<N> ai(simulationTimes, threadCount, static_cast<searchMode>(parallelMode));
+    ThreatSearch<N> threats;
+    AlphaBeta<N> alphaBeta;
+    OpeningBook<N> book;
+    if (book.open(DEFAULT_BOOK_PATH)) {
+        cout << "Loaded opening book with " << book.size() << " positions" << endl;
+    }
+    cout << "Choose playout policy: 1 = random, 2 = pattern" << endl;
+    while (true) {
+        cin >> policy;
+        if (policy == playoutPolicy::RANDOM_PLAYOUT || policy == playoutPolicy::PATTERN_PLAYOUT) {
+            break;
+        }
+        cout << "Please input 1 or 2" << endl;
+    }
+    ai.setPlayoutPolicy(static_cast<playoutPolicy>(policy));
+    cout << "Keep thinking while waiting for your move? 1 = yes, 2 = no" << endl;
+    while (true) {
+        cin >> pondering;
+        if (pondering == 1 || pondering == 2) {
+            break;
+        }
+        cout << "Please input 1 or 2" << endl;
+    }
+    // 指定種子時（同樣的輸入順序下）整盤棋可以重現，用於重播有問題的對局
+    cout << "Input a random seed to make the AI reproducible, or 0 for a random one" << endl;
+    unsigned long long seed;
+    cin >> seed;
+    if (seed != 0) {
+        ai.setSeed(seed);
+    }
+    // generateFullTree(root);
+    Node<N>* currentNode = ai.createRoot();  // CurrentNode為當前棋盤最後一個子的節點，會去選擇他的子節點來下棋
     ai.expansion(currentNode);
-    cout << "Choose AI simulation mode: 1 = fixed simulation times, 2 = "
-            "variable simulation times"
-         << endl;
+    cout << "Choose AI engine: 1 = MCTS, 2 = alpha-beta" << endl;
+    while (true) {
+        cin >> engine;
+        if (engine == aiEngine::MCTS_ENGINE || engine == aiEngine::ALPHA_BETA_ENGINE) {
+            break;
+        }
+        cout << "Please input 1 or 2" << endl;
+    }
+    // alpha-beta 以迭代加深搜尋，只支援每步限時
+    if (engine == aiEngine::ALPHA_BETA_ENGINE) {
+        cout << "Choose AI simulation mode: 3 = time limit per move" << endl;
+    } else {
+        cout << "Choose AI simulation mode: 1 = fixed simulation times, 2 = "
+                "variable simulation times, 3 = time limit per move"
+             << endl;
+    }
     while (true) {
         cin >> aiMode;
+        if (engine == aiEngine::ALPHA_BETA_ENGINE && aiMode != aiMode::TIME_LIMIT) {
+            cout << "Please input 3" << endl;
+            continue;
+        }
         if (aiMode == aiMode::FIXED_SIMULATION_TIMES) {
             while (true) {
-                cout << "Input how many iteration you want to run (must be "
-                        "greater than 225)."
+                cout << "Input how many iteration you want to run (must be greater than " << Board<N>::CELLS << ")."
                      << endl;
                 cin >> iterationTimes;
-                if (iterationTimes > MAX_CHILDREN) {
+                if (iterationTimes > Board<N>::CELLS) {
                     break;
                 }
-                cout << "Please input a number greater than 225." << endl;
+                cout << "Please input a number greater than " << Board<N>::CELLS << "." << endl;
             }
             break;
         }
         if (aiMode == aiMode::VARIABLE_SIMULATION_TIMES) {
             break;
         }
-        cout << "Please input 1 or 2" << endl;
+        if (aiMode == aiMode::TIME_LIMIT) {
+            while (true) {
+                cout << "Input how many milliseconds the AI can think per move." << endl;
+                cin >> timeLimit;
+                if (timeLimit > 0) {
+                    break;
+                }
+                cout << "Please input a positive number." << endl;
+            }
+            break;
+        }
+        cout << "Please input 1, 2 or 3" << endl;
     }
     // 用 bitboard 表示棋盤，初始皆為 0
-    uint64_t boardBlack[BITBOARD_COUNT];
-    uint64_t boardWhite[BITBOARD_COUNT];
+    uint64_t boardBlack[Board<N>::BITBOARD_COUNT];
+    uint64_t boardWhite[Board<N>::BITBOARD_COUNT];
     memset(boardBlack, 0, sizeof(boardBlack));
     memset(boardWhite, 0, sizeof(boardWhite));
-    boardBlack[3] = 0xFFFFFFFE00000000;  // 沒用到的bit直接賦值為1=佔據
-    boardWhite[3] = 0xFFFFFFFE00000000;  // 沒用到的bit直接賦值為1=佔據
+    boardBlack[Board<N>::BITBOARD_COUNT - 1] = Board<N>::PADDING_MASK;  // 沒用到的bit直接賦值為1=佔據
+    boardWhite[Board<N>::BITBOARD_COUNT - 1] = Board<N>::PADDING_MASK;  // 沒用到的bit直接賦值為1=佔據
     cout << "Choose first or second player, input 1 or 2" << endl;
     while (true) {  // 選擇先手或後手，防白痴crash程式
         cin >> playerOrder;
@@ -67,7 +140,7 @@ void Game::startGame() {
     }
     playerOrder--;
     while (true) {
-        if (currentOrder == MAX_CHILDREN) {
+        if (currentOrder == Board<N>::CELLS) {
             cout << "Draw" << endl;
             printBoard(boardBlack, boardWhite, currentNode->lastMove);
             break;
@@ -76,86 +149,93 @@ void Game::startGame() {
         if (currentOrder % 2 == playerOrder) {  // Player turn
             showEachNodeInformation(currentNode);
             cout << "Your turn" << endl;
+            // 等待輸入的同時在背景從目前局面繼續搜尋，空棋盤沒有候選點就不必搜尋
+            if (engine == aiEngine::MCTS_ENGINE && pondering == 1 && currentOrder > 0) {
+                ai.startPondering(currentNode);
+            }
             int X, Y;
-            cout << "input X Y 0~14" << endl;
+            cout << "input X Y 0~" << N - 1 << endl;
             while (true) {
                 cin >> X >> Y;
-                if (X < 0 || X > (BOARD_SIZE - 1) || Y < 0 || Y > (BOARD_SIZE - 1)) {
-                    cout << "Please input 0~14" << endl;
+                if (X < 0 || X > (N - 1) || Y < 0 || Y > (N - 1)) {
+                    cout << "Please input 0~" << N - 1 << endl;
                     continue;
                 }
                 // 檢查該位置是否已被佔用
-                if (getBit(boardBlack, {X, Y}) || getBit(boardWhite, {X, Y})) {
+                if (Board<N>::getBit(boardBlack, {X, Y}) || Board<N>::getBit(boardWhite, {X, Y})) {
                     cout << "This position is already taken" << endl;
                     continue;
                 }
                 break;
             }
+            ai.stopPondering();
             if (currentOrder % 2 == 0) {
-                setBit(boardBlack, {X, Y});
+                Board<N>::setBit(boardBlack, {X, Y});
             } else {
-                setBit(boardWhite, {X, Y});
+                Board<N>::setBit(boardWhite, {X, Y});
             }
             if (currentOrder >= CHECKWIN_THRESHOLD && checkWin({X, Y}, boardBlack, boardWhite, currentOrder % 2 == 0)) {
                 cout << "You win" << endl;
                 printBoard(boardBlack, boardWhite, currentNode->lastMove);
                 break;
             }
-            bool found = false;
-            for (int i = 0; i < MAX_CHILDREN && currentNode->children[i] != nullptr; i++) {
-                if (currentNode->children[i]->lastMove.x == X && currentNode->children[i]->lastMove.y == Y) {
-                    currentNode = currentNode->children[i];
-                    found = true;
-                    break;
-                }
-            }
-            // 如果玩家的落子不在拓展的節點中，則新建一個節點並加入
-            if (!found) {
-                Node* newNode = new Node({X, Y}, currentNode);
-                currentNode->children[0] = newNode;
-                currentNode = newNode;
-            }
+            currentNode = ai.advanceRoot(currentNode, {X, Y});
         } else {  // AI turn
             cout << "AI turn" << endl;
             if (aiMode == aiMode::VARIABLE_SIMULATION_TIMES) {
-                cout << "Input how many iteration you want to run (must be "
-                        "greater than 225)."
+                cout << "Input how many iteration you want to run (must be greater than " << Board<N>::CELLS << ")."
                      << endl;
                 do {
                     cin >> iterationTimes;
-                    if (iterationTimes <= MAX_CHILDREN) {
-                        cout << "Please input a number greater than 225." << endl;
+                    if (iterationTimes <= Board<N>::CELLS) {
+                        cout << "Please input a number greater than " << Board<N>::CELLS << "." << endl;
                     }
-                } while (iterationTimes <= MAX_CHILDREN);
-            }
-            if (currentOrder == 0) {
-                Node* newNode = new Node({7, 7}, currentNode);
-                currentNode->children[0] = newNode;
-                currentNode = newNode;
-                setBit(boardBlack, {7, 7});
-                cout << "AI choose " << "7" << " " << "7" << endl;
-                currentOrder++;
-                continue;
+                } while (iterationTimes <= Board<N>::CELLS);
             }
-            ai.run(currentNode, iterationTimes);
-            Node* bestChild = nullptr;
-            int mostVisit = 0;
-            for (int i = 0; i < MAX_CHILDREN && currentNode->children[i] != nullptr; ++i) {
-                Node* child = currentNode->children[i];
-                if (child->visits > mostVisit) {
-                    mostVisit = child->visits;
-                    bestChild = child;
+            // 開局庫收錄的局面直接照著下，不必搜尋
+            Position lastMove = book.probe(currentNode);
+            if (lastMove.x >= 0) {
+                cout << "AI played a book move" << endl;
+            } else if (currentOrder == 0) {
+                lastMove = {N / 2, N / 2};  // 開局庫沒有收錄空棋盤時第一手直接下天元
+            } else {
+                // 先以連續威脅搜尋找必勝手順，找到就不必再跑 MCTS
+                lastMove = threats.findWin(currentNode);
+                if (lastMove.x >= 0) {
+                    cout << "AI found a forced win by continuous threats" << endl;
+                } else if (engine == aiEngine::ALPHA_BETA_ENGINE) {
+                    lastMove = alphaBeta.search(currentNode, timeLimit);
+                    cout << "AI searched " << alphaBeta.nodesSearched() << " nodes to depth "
+                         << alphaBeta.completedDepth() << ", score " << alphaBeta.lastScore() << endl;
+                } else {
+                    if (aiMode == aiMode::TIME_LIMIT) {
+                        int iterations = ai.runFor(currentNode, timeLimit);
+                        cout << "AI ran " << iterations << " iterations" << endl;
+                    } else {
+                        ai.run(currentNode, iterationTimes);
+                    }
+#ifdef GOMOKU_INSTRUMENT
+                    ai.printInstrumentation(cout);
+#endif
+                    // 根節點被證明必敗代表輪到的 AI 有必勝著
+                    if (currentNode->proven == PROVEN_LOSS) {
+                        cout << "AI found a forced win" << endl;
+                    } else if (currentNode->proven == PROVEN_WIN) {
+                        cout << "AI is facing a forced loss" << endl;
+                    }
+                    cout << "Search tree: " << ai.treeSize() << " nodes, " << ai.memoryUsage() / (1 << 20) << " MB"
+                         << endl;
+                    showEachNodeInformation(currentNode);
+                    lastMove = ai.bestChild(currentNode)->lastMove;
                 }
             }
-            Position lastMove = bestChild->lastMove;
             if (currentOrder % 2 == 0) {
-                setBit(boardBlack, lastMove);
+                Board<N>::setBit(boardBlack, lastMove);
             } else {
-                setBit(boardWhite, lastMove);
+                Board<N>::setBit(boardWhite, lastMove);
             }
-            showEachNodeInformation(currentNode);
             cout << "AI choose " << lastMove.x << " " << lastMove.y << endl;
-            currentNode = bestChild;
+            currentNode = ai.advanceRoot(currentNode, lastMove);
             if (currentOrder >= CHECKWIN_THRESHOLD &&
                 checkWin(lastMove, boardBlack, boardWhite, currentOrder % 2 == 0)) {
                 cout << "AI win" << endl;
@@ -164,23 +244,16 @@ void Game::startGame() {
             }
         }
         currentOrder++;
-        Node* parent = currentNode->parent;
-        for (int i = 0; i < MAX_CHILDREN && parent->children[i] != nullptr; i++) {
-            if (parent->children[i] == currentNode) {
-                continue;
-            }
-            deleteTree(parent->children[i]);
-        }
     }
-    delete root;
 }
 
-void Game::printBoard(uint64_t* boardBlack, uint64_t* boardWhite, Position lastMove) {
+template <int N>
+void Game<N>::printBoard(uint64_t* boardBlack, uint64_t* boardWhite, Position lastMove) {
     cout << endl;
 
-    // 印出上方的欄位標題（0 ~ BOARD_SIZE-1）
+    // 印出上方的欄位標題（0 ~ N-1）
     cout << "    ";  // 左上角空白區域
-    for (int j = 0; j < BOARD_SIZE; j++) {
+    for (int j = 0; j < N; j++) {
         // 為了對齊，假設 j 為單一數字時多留兩個空格，兩位數則一個空格
         if (j < 10)
             cout << j << "   ";
@@ -191,13 +264,13 @@ void Game::printBoard(uint64_t* boardBlack, uint64_t* boardWhite, Position lastM
 
     // 印出上方的分隔線
     cout << "   ";
-    for (int j = 0; j < BOARD_SIZE; j++) {
+    for (int j = 0; j < N; j++) {
         cout << "----";
     }
     cout << endl;
 
     // 印出每一列
-    for (int i = 0; i < BOARD_SIZE; i++) {
+    for (int i = 0; i < N; i++) {
         // 印出行號（左邊標題）
         if (i < 10)
             cout << i << "  |";
@@ -205,14 +278,14 @@ void Game::printBoard(uint64_t* boardBlack, uint64_t* boardWhite, Position lastM
             cout << i << " |";
 
         // 印出該行的每個棋子
-        for (int j = 0; j < BOARD_SIZE; j++) {
-            if (getBit(boardBlack, {i, j})) {
+        for (int j = 0; j < N; j++) {
+            if (Board<N>::getBit(boardBlack, {i, j})) {
                 if (i == lastMove.x && j == lastMove.y) {
                     cout << RED << " X " << DEFAULT;
                 } else {
                     cout << YELLOW << " X " << DEFAULT;
                 }
-            } else if (getBit(boardWhite, {i, j})) {
+            } else if (Board<N>::getBit(boardWhite, {i, j})) {
                 if (i == lastMove.x && j == lastMove.y) {
                     cout << RED << " O " << DEFAULT;
                 } else {
@@ -221,21 +294,21 @@ void Game::printBoard(uint64_t* boardBlack, uint64_t* boardWhite, Position lastM
             } else {
                 cout << "   ";
             }
-            if (j < BOARD_SIZE - 1) {
+            if (j < N - 1) {
                 cout << "|";
             }
         }
         cout << endl;
 
         // 每行後面加上分隔線（除了最後一行）
-        if (i < BOARD_SIZE - 1) {
+        if (i < N - 1) {
             cout << "   ";  // 與行號對齊的空白
-            for (int j = 0; j < BOARD_SIZE; j++) {
+            for (int j = 0; j < N; j++) {
                 if (j == 0) {
                     cout << "-";
                 }
                 cout << "---";
-                if (j < BOARD_SIZE - 1) {
+                if (j < N - 1) {
                     cout << "+";
                 }
             }
@@ -244,7 +317,7 @@ void Game::printBoard(uint64_t* boardBlack, uint64_t* boardWhite, Position lastM
     }
     // 印出下方的分隔線
     cout << "   ";
-    for (int j = 0; j < BOARD_SIZE; j++) {
+    for (int j = 0; j < N; j++) {
         cout << "----";
     }
     cout << endl;
@@ -281,26 +354,27 @@ void Game::generateFullTree(Node* node) {
 }
 */
 // 檢查某個方向是否有連續5顆棋子
-bool Game::checkDirection(Position lastMove, Position direction, uint64_t* board) {
+template <int N>
+bool Game<N>::checkDirection(Position lastMove, Position direction, uint64_t* board) {
     int count = 1;  // 目前這顆棋子算1個
     int x = lastMove.x, y = lastMove.y;
     int dx = direction.x, dy = direction.y;
     for (int i = 1; i < 5; i++) {
         int nx = x + dx * i, ny = y + dy * i;
-        if (nx < 0 || ny < 0 || nx >= BOARD_SIZE || ny >= BOARD_SIZE || !getBit(board, {nx, ny})) break;
+        if (nx < 0 || ny < 0 || nx >= N || ny >= N || !Board<N>::getBit(board, {nx, ny})) break;
         count++;
     }
     for (int i = 1; i < 5; i++) {
         int nx = x - dx * i, ny = y - dy * i;
-        if (nx < 0 || ny < 0 || nx >= BOARD_SIZE || ny >= BOARD_SIZE || !getBit(board, {nx, ny})) break;
+        if (nx < 0 || ny < 0 || nx >= N || ny >= N || !Board<N>::getBit(board, {nx, ny})) break;
         count++;
     }
     return count >= 5;
 }
 
 // 總體檢查是否勝利
-bool Game::checkWin(Position lastMove, uint64_t boardBlack[BITBOARD_COUNT], uint64_t boardWhite[BITBOARD_COUNT],
-                    bool isBlackTurn) {
+template <int N>
+bool Game<N>::checkWin(Position lastMove, uint64_t* boardBlack, uint64_t* boardWhite, bool isBlackTurn) {
     static const Position directions[4] = {{1, 0}, {0, 1}, {1, 1}, {1, -1}};
 
     uint64_t* targetBoard = isBlackTurn ? boardBlack : boardWhite;
@@ -310,13 +384,18 @@ bool Game::checkWin(Position lastMove, uint64_t boardBlack[BITBOARD_COUNT], uint
            checkDirection(lastMove, directions[2], targetBoard) ||  // 斜對角（\）
            checkDirection(lastMove, directions[3], targetBoard);    // 斜對角（/）
 }
-void Game::showEachNodeInformation(Node* currentNode) {
-    for (int i = 0; i < MAX_CHILDREN && currentNode->children[i] != nullptr; i++) {
+template <int N>
+void Game<N>::showEachNodeInformation(Node<N>* currentNode) {
+    for (int i = 0; i < currentNode->childCount; i++) {
+        Node<N>* child = &currentNode->children[i];
         // 設定固定格式與寬度
-        std::cout << std::fixed << std::setprecision(3) << "move: " << std::setw(3)
-                  << currentNode->children[i]->lastMove.x << " " << std::setw(3) << currentNode->children[i]->lastMove.y
-                  << " | wins: " << std::setw(8) << currentNode->children[i]->wins << " | visits: " << std::setw(8)
-                  << currentNode->children[i]->visits << " | winRate: " << std::setw(8)
-                  << (currentNode->children[i]->wins / currentNode->children[i]->visits) << std::endl;
+        std::cout << std::fixed << std::setprecision(3) << "move: " << std::setw(3) << child->lastMove.x << " "
+                  << std::setw(3) << child->lastMove.y << " | wins: " << std::setw(8) << child->wins
+                  << " | visits: " << std::setw(8) << child->visits << " | winRate: " << std::setw(8)
+                  << (child->wins / child->visits) << std::endl;
     }
-}
\ No newline at end of file
+}
+
+template class Game<9>;
+template class Game<15>;
+template class Game<19>;
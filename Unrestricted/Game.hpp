@@ -1,16 +1,24 @@
 #ifndef GAME_HPP
 #define GAME_HPP
 #include <stdint.h>
-const int BOARD_SIZE = 15;
+const int DEFAULT_BOARD_SIZE = 15;  ///< 對局程式與基準測試預設使用的棋盤大小
 const int CHECKWIN_THRESHOLD = 4;
+template <int N>
 struct Node;
 struct Position;
-enum aiMode { FIXED_SIMULATION_TIMES = 1, VARIABLE_SIMULATION_TIMES = 2 };
+enum aiMode { FIXED_SIMULATION_TIMES = 1, VARIABLE_SIMULATION_TIMES = 2, TIME_LIMIT = 3 };
+enum aiEngine { MCTS_ENGINE = 1, ALPHA_BETA_ENGINE = 2 };
 
+/**
+ * @brief N x N 棋盤的對局流程與勝負判斷
+ *
+ * 樣板只在 Game.cpp 中對支援的棋盤大小（9、15、19）明確實例化。
+ */
+template <int N>
 class Game {
    private:
     static bool checkDirection(Position lastMove, Position direction, uint64_t* board);
-    static void showEachNodeInformation(Node* currentNode);
+    static void showEachNodeInformation(Node<N>* currentNode);
 
    public:
     /**
@@ -50,4 +58,8 @@ class Game {
     // static void generateFullTree(Node* node);
 };
 
+extern template class Game<9>;
+extern template class Game<15>;
+extern template class Game<19>;
+
 #endif  // GAME_HPP
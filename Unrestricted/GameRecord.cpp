@@ -0,0 +1,55 @@
+#include "GameRecord.hpp"
+
+#include <cstring>
+
+namespace GameRecord {
+
+void Builder::begin(int boardSize, uint64_t seed) {
+    RecordHeader header = {MAGIC, VERSION, static_cast<uint8_t>(boardSize), 0, 0, 0, 0, seed};
+    bytes.resize(sizeof(header));
+    memcpy(bytes.data(), &header, sizeof(header));
+    moveCount = 0;
+}
+
+void Builder::addMove(int move, uint32_t micros, const VisitEntry* visits, int childCount) {
+    MoveHeader header = {static_cast<uint16_t>(move), static_cast<uint16_t>(childCount), micros};
+    size_t offset = bytes.size();
+    bytes.resize(offset + sizeof(header) + childCount * sizeof(VisitEntry));
+    memcpy(bytes.data() + offset, &header, sizeof(header));
+    if (childCount > 0) {
+        memcpy(bytes.data() + offset + sizeof(header), visits, childCount * sizeof(VisitEntry));
+    }
+    moveCount++;
+}
+
+const std::vector<unsigned char>& Builder::finish(int winner) {
+    RecordHeader header;
+    memcpy(&header, bytes.data(), sizeof(header));
+    header.winner = static_cast<int8_t>(winner);
+    header.moveCount = moveCount;
+    header.byteLength = static_cast<uint32_t>(bytes.size());
+    memcpy(bytes.data(), &header, sizeof(header));
+    return bytes;
+}
+
+bool Writer::open(const char* path) {
+    close();
+    file = fopen(path, "ab");
+    return file != nullptr;
+}
+
+void Writer::close() {
+    if (file != nullptr) {
+        fclose(file);
+        file = nullptr;
+    }
+}
+
+bool Writer::append(const std::vector<unsigned char>& record) {
+    std::lock_guard<std::mutex> lock(mutex);
+    // 每筆紀錄一次 fwrite 後立即 flush，其他執行緒的紀錄不會插進來，中止時也只會少最後一筆
+    bool ok = fwrite(record.data(), 1, record.size(), file) == record.size();
+    return fflush(file) == 0 && ok;
+}
+
+}  // namespace GameRecord
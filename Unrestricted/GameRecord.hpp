@@ -0,0 +1,119 @@
+#ifndef GAMERECORD_HPP
+#define GAMERECORD_HPP
+
+#include <stdint.h>
+
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+#include "MappedFile.hpp"
+
+/**
+ * @brief 自我對弈棋譜的二進位格式（本機位元組序）
+ *
+ * 檔案是一筆接一筆的對局紀錄，只會在尾端附加。每筆紀錄：
+ * - RecordHeader（24 byte），byteLength 是整筆紀錄（含檔頭）的長度
+ * - moveCount 個著手，每個著手是 MoveHeader（8 byte）加上 childCount 個 VisitEntry（8 byte），
+ *   也就是落子前根節點每個子節點的訪問次數，可直接作為策略的訓練目標
+ *
+ * 整筆紀錄在記憶體中組好後一次寫入，程式中途被中止時最多只會留下最後一筆不完整的紀錄，
+ * 讀取時以 byteLength 檢查後略過即可；要繼續附加前需先把檔案截到最後一筆完整紀錄，否則之後的紀錄讀不到。
+ */
+namespace GameRecord {
+
+constexpr uint32_t MAGIC = 0x43455247;  ///< "GREC"
+constexpr uint8_t VERSION = 1;
+
+struct RecordHeader {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t boardSize;
+    int8_t winner;  ///< 1 = 黑勝，-1 = 白勝，0 = 平手
+    uint8_t reserved;
+    uint32_t moveCount;
+    uint32_t byteLength;
+    uint64_t seed;  ///< 產生這盤棋的種子，可用來重播
+};
+
+struct MoveHeader {
+    uint16_t move;        ///< 格子索引 x * N + y
+    uint16_t childCount;  ///< 之後的 VisitEntry 數量，沒有搜尋（例如第一手天元）時為 0
+    uint32_t micros;      ///< 這一步的思考時間（微秒）
+};
+
+struct VisitEntry {
+    uint16_t move;
+    uint16_t reserved;
+    uint32_t visits;
+};
+
+static_assert(sizeof(RecordHeader) == 24 && sizeof(MoveHeader) == 8 && sizeof(VisitEntry) == 8,
+              "檔案格式不能有額外的 padding");
+
+/**
+ * @brief 在記憶體中組一筆紀錄
+ */
+class Builder {
+   public:
+    void begin(int boardSize, uint64_t seed);
+    void addMove(int move, uint32_t micros, const VisitEntry* visits, int childCount);
+    /// @brief 填好勝負與長度，回傳整筆紀錄的位元組
+    const std::vector<unsigned char>& finish(int winner);
+
+   private:
+    std::vector<unsigned char> bytes;
+    uint32_t moveCount = 0;
+};
+
+/**
+ * @brief 以附加模式寫入紀錄檔，多個執行緒可以同時呼叫 append
+ */
+class Writer {
+   public:
+    ~Writer() { close(); }
+    bool open(const char* path);
+    void close();
+    /// @brief 寫入一筆完整的紀錄，寫入失敗時回傳 false
+    bool append(const std::vector<unsigned char>& record);
+
+   private:
+    FILE* file = nullptr;
+    std::mutex mutex;
+};
+
+/**
+ * @brief 以記憶體映射逐筆讀取紀錄檔，不會複製或解析任何著手
+ */
+class Reader {
+   public:
+    bool open(const char* path) { return file.open(path); }
+
+    /**
+     * @brief 對每筆完整的紀錄呼叫 visit(header, 指向第一個 MoveHeader 的指標)，回傳紀錄數
+     *
+     * 遇到格式錯誤或不完整的尾端紀錄即停止。
+     */
+    template <class Visitor>
+    size_t forEach(Visitor&& visit) const {
+        size_t offset = 0, count = 0;
+        while (offset + sizeof(RecordHeader) <= file.size()) {
+            const RecordHeader* header = reinterpret_cast<const RecordHeader*>(file.data() + offset);
+            if (header->magic != MAGIC || header->byteLength < sizeof(RecordHeader) ||
+                offset + header->byteLength > file.size()) {
+                break;
+            }
+            visit(*header, file.data() + offset + sizeof(RecordHeader));
+            offset += header->byteLength;
+            count++;
+        }
+        return count;
+    }
+
+   private:
+    MappedFile file;
+};
+
+}  // namespace GameRecord
+
+#endif  // GAMERECORD_HPP
@@ -0,0 +1,276 @@
+#ifndef INSTRUMENT_HPP
+#define INSTRUMENT_HPP
+
+/**
+ * @brief 搜尋的量測層：各階段耗時、節點與 playout 計數、最大深度、執行緒池排隊時間
+ *
+ * 只有在定義 GOMOKU_INSTRUMENT 時才會編譯進來（CMake 選項 -DGOMOKU_INSTRUMENT=ON），
+ * 否則所有 INSTRUMENT_* 巨集都展開成空敘述，release 版本沒有任何額外成本。
+ *
+ * 每個執行緒有自己的計數區塊，熱路徑上只寫自己的區塊（relaxed 的 load + store，沒有 lock 前綴）；
+ * 執行緒結束時把區塊的快照交回登錄表，報表再把存活與已結束的執行緒加總。
+ */
+#ifdef GOMOKU_INSTRUMENT
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace instrument {
+
+enum SearchPhase { SELECTION = 0, EXPANSION = 1, PLAYOUT = 2, BACKPROPAGATION = 3, PHASE_COUNT = 4 };
+inline const char* const PHASE_NAMES[PHASE_COUNT] = {"selection", "expansion", "playout", "backpropagation"};
+
+/**
+ * @brief 讀取 cycle 計數器：x86 用 rdtsc、ARM64 用 cntvct_el0，其他平台退回 steady_clock 的奈秒
+ */
+inline uint64_t readCycles() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t value;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(value));
+    return value;
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+#endif
+}
+
+/// @brief 只由擁有者寫入的計數器，其他執行緒讀取報表時不構成資料競爭
+struct Counter {
+    std::atomic<uint64_t> value{0};
+
+    void add(uint64_t amount) { value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed); }
+    void max(uint64_t candidate) {
+        if (candidate > value.load(std::memory_order_relaxed)) {
+            value.store(candidate, std::memory_order_relaxed);
+        }
+    }
+    uint64_t get() const { return value.load(std::memory_order_relaxed); }
+    void reset() { value.store(0, std::memory_order_relaxed); }
+};
+
+/// @brief 一個執行緒的所有計數
+struct alignas(64) ThreadCounters {
+    Counter phaseCycles[PHASE_COUNT];
+    Counter iterations;
+    Counter nodesCreated;
+    Counter playouts;
+    Counter playoutMoves;
+    Counter maxDepth;
+    Counter queuedTasks;      ///< 從執行緒池取出的工作數
+    Counter queueWaitCycles;  ///< 工作從提交到開始執行的總 cycle 數
+
+    void reset() {
+        for (Counter& c : phaseCycles) c.reset();
+        iterations.reset();
+        nodesCreated.reset();
+        playouts.reset();
+        playoutMoves.reset();
+        maxDepth.reset();
+        queuedTasks.reset();
+        queueWaitCycles.reset();
+    }
+};
+
+/// @brief 計數的普通數值快照，用於加總與輸出
+struct Snapshot {
+    uint64_t phaseCycles[PHASE_COUNT] = {};
+    uint64_t iterations = 0;
+    uint64_t nodesCreated = 0;
+    uint64_t playouts = 0;
+    uint64_t playoutMoves = 0;
+    uint64_t maxDepth = 0;
+    uint64_t queuedTasks = 0;
+    uint64_t queueWaitCycles = 0;
+
+    explicit Snapshot(const ThreadCounters& c) {
+        for (int i = 0; i < PHASE_COUNT; i++) phaseCycles[i] = c.phaseCycles[i].get();
+        iterations = c.iterations.get();
+        nodesCreated = c.nodesCreated.get();
+        playouts = c.playouts.get();
+        playoutMoves = c.playoutMoves.get();
+        maxDepth = c.maxDepth.get();
+        queuedTasks = c.queuedTasks.get();
+        queueWaitCycles = c.queueWaitCycles.get();
+    }
+    Snapshot() = default;
+
+    void merge(const Snapshot& other) {
+        for (int i = 0; i < PHASE_COUNT; i++) phaseCycles[i] += other.phaseCycles[i];
+        iterations += other.iterations;
+        nodesCreated += other.nodesCreated;
+        playouts += other.playouts;
+        playoutMoves += other.playoutMoves;
+        maxDepth = std::max(maxDepth, other.maxDepth);
+        queuedTasks += other.queuedTasks;
+        queueWaitCycles += other.queueWaitCycles;
+    }
+    bool empty() const { return iterations == 0 && playouts == 0 && queuedTasks == 0; }
+};
+
+/**
+ * @brief 所有執行緒計數區塊的登錄表
+ */
+class Registry {
+   private:
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadCounters>> blocks;  ///< 所有配置過的區塊（含閒置可重用的）
+    std::vector<ThreadCounters*> freeBlocks;              ///< 已結束執行緒留下、可重用的區塊
+    std::vector<Snapshot> finished;                       ///< 上次 reset 後結束的執行緒的計數
+
+   public:
+    ThreadCounters* acquire() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!freeBlocks.empty()) {
+            ThreadCounters* block = freeBlocks.back();
+            freeBlocks.pop_back();
+            return block;
+        }
+        blocks.push_back(std::make_unique<ThreadCounters>());
+        return blocks.back().get();
+    }
+
+    void release(ThreadCounters* block) {
+        std::lock_guard<std::mutex> lock(mutex);
+        Snapshot snapshot(*block);
+        if (!snapshot.empty()) {
+            finished.push_back(snapshot);
+        }
+        block->reset();
+        freeBlocks.push_back(block);
+    }
+
+    /// @brief 歸零所有計數，呼叫時不應有搜尋正在進行
+    void reset() {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& block : blocks) block->reset();
+        finished.clear();
+    }
+
+    /// @brief 每個曾經做過事的執行緒一筆快照（含已結束的執行緒）
+    std::vector<Snapshot> collect() {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<Snapshot> result = finished;
+        for (auto& block : blocks) {
+            Snapshot snapshot(*block);
+            if (!snapshot.empty()) {
+                result.push_back(snapshot);
+            }
+        }
+        return result;
+    }
+};
+
+/// 刻意不釋放：執行緒池的 worker 在靜態物件解構時才結束，屆時仍要把區塊交回
+inline Registry& registry() {
+    static Registry* instance = new Registry;
+    return *instance;
+}
+
+/// @brief 執行緒第一次記錄時向登錄表要一個區塊，執行緒結束時交還
+struct ThreadSlot {
+    ThreadCounters* counters = registry().acquire();
+    ~ThreadSlot() { registry().release(counters); }
+};
+
+inline ThreadCounters& local() {
+    thread_local ThreadSlot slot;
+    return *slot.counters;
+}
+
+/// @brief 把所在範圍的 cycle 數累加到某個階段
+class PhaseTimer {
+   private:
+    SearchPhase phase;
+    uint64_t start;
+
+   public:
+    explicit PhaseTimer(SearchPhase phase) : phase(phase), start(readCycles()) {}
+    ~PhaseTimer() { local().phaseCycles[phase].add(readCycles() - start); }
+};
+
+/**
+ * @brief 一次搜尋的量測區間，記錄牆鐘時間與 cycle 數以換算 cycle 與毫秒
+ */
+struct SearchWindow {
+    std::chrono::steady_clock::time_point startTime;
+    uint64_t startCycles = 0;
+    double elapsedMs = 0;
+    uint64_t elapsedCycles = 0;
+
+    void begin() {
+        registry().reset();
+        startTime = std::chrono::steady_clock::now();
+        startCycles = readCycles();
+    }
+    void end() {
+        elapsedCycles = readCycles() - startCycles;
+        elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    }
+    double toMs(uint64_t cycles) const { return elapsedCycles == 0 ? 0 : cycles * elapsedMs / elapsedCycles; }
+};
+
+/**
+ * @brief 輸出最近一次搜尋的報表：總計與每個執行緒各一行
+ */
+inline void printReport(std::ostream& out, const SearchWindow& window) {
+    std::vector<Snapshot> threads = registry().collect();
+    Snapshot total;
+    for (const Snapshot& s : threads) total.merge(s);
+    double seconds = window.elapsedMs / 1000;
+    out << "[instrument] search " << window.elapsedMs << " ms, " << total.iterations << " iterations, "
+        << total.nodesCreated << " nodes created, max depth " << total.maxDepth << std::endl;
+    out << "[instrument] phase time (ms, summed over threads):";
+    for (int i = 0; i < PHASE_COUNT; i++) {
+        out << " " << PHASE_NAMES[i] << " " << window.toMs(total.phaseCycles[i]);
+    }
+    out << std::endl;
+    out << "[instrument] playouts " << total.playouts << " ("
+        << (seconds > 0 ? total.playouts / seconds : 0) << "/s), average length "
+        << (total.playouts > 0 ? static_cast<double>(total.playoutMoves) / total.playouts : 0) << " moves" << std::endl;
+    out << "[instrument] thread pool: " << total.queuedTasks << " tasks, average queue wait "
+        << (total.queuedTasks > 0 ? window.toMs(total.queueWaitCycles) * 1000 / total.queuedTasks : 0) << " us"
+        << std::endl;
+    for (size_t i = 0; i < threads.size(); i++) {
+        out << "[instrument]   thread " << i << ": " << threads[i].iterations << " iterations, "
+            << threads[i].playouts << " playouts (" << (seconds > 0 ? threads[i].playouts / seconds : 0) << "/s)"
+            << std::endl;
+    }
+}
+
+}  // namespace instrument
+
+#define INSTRUMENT_CONCAT_INNER(a, b) a##b
+#define INSTRUMENT_CONCAT(a, b) INSTRUMENT_CONCAT_INNER(a, b)
+/// 把目前範圍剩下的時間記到某個階段
+#define INSTRUMENT_PHASE(phase) instrument::PhaseTimer INSTRUMENT_CONCAT(phaseTimer, __LINE__)(instrument::phase)
+/// 累加目前執行緒的某個計數
+#define INSTRUMENT_ADD(counter, amount) instrument::local().counter.add(amount)
+/// 更新目前執行緒某個計數的最大值
+#define INSTRUMENT_MAX(counter, value) instrument::local().counter.max(value)
+/// 只在量測版本中保留的敘述
+#define INSTRUMENT_ONLY(statement) statement
+
+#else
+
+#define INSTRUMENT_PHASE(phase) ((void)0)
+#define INSTRUMENT_ADD(counter, amount) ((void)0)
+#define INSTRUMENT_MAX(counter, value) ((void)0)
+#define INSTRUMENT_ONLY(statement)
+
+#endif  // GOMOKU_INSTRUMENT
+
+#endif  // INSTRUMENT_HPP
@@ -0,0 +1,141 @@
+#ifndef LINEBOARD_HPP
+#define LINEBOARD_HPP
+
+#include <stdint.h>
+
+#include <array>
+#include <cstring>
+
+#include "Bitboard.hpp"
+
+/**
+ * @brief 以「線」為單位的棋盤編碼，用於常數時間的五連判斷
+ *
+ * 每種顏色各保留四組線：橫列、直行、主對角線（\）、副對角線（/）。
+ * 每條線是一個 uint32_t，線上第 k 格對應第 k + LINE_OFFSET 個 bit；前後各留 LINE_OFFSET 個空 bit，
+ * 讓「以某格為中心取出前後四格」永遠不需要處理負的位移。
+ * 落子時只需要更新通過該格的四條線，判斷五連則是每個方向一次 mask-and-compare。
+ */
+constexpr int LINE_OFFSET = 4;      ///< 每條線前方保留的空 bit 數
+constexpr int DIRECTION_COUNT = 4;  ///< 橫、直、\、/
+
+/// N x N 棋盤每個方向最多的線數（對角線數量）
+constexpr int lineCount(int size) { return 2 * size - 1; }
+
+/// @brief 某格在某方向上所屬的線與該格在線上的 bit 位置
+struct LineSlot {
+    uint8_t line;
+    uint8_t bit;
+};
+
+template <int N>
+constexpr std::array<std::array<LineSlot, N * N>, DIRECTION_COUNT> createLineSlotTable() {
+    std::array<std::array<LineSlot, N * N>, DIRECTION_COUNT> table{};
+    for (int pos = 0; pos < N * N; pos++) {
+        int x = pos / N, y = pos % N;
+        table[0][pos] = {static_cast<uint8_t>(x), static_cast<uint8_t>(y + LINE_OFFSET)};              // 橫列
+        table[1][pos] = {static_cast<uint8_t>(y), static_cast<uint8_t>(x + LINE_OFFSET)};              // 直行
+        table[2][pos] = {static_cast<uint8_t>(x - y + N - 1), static_cast<uint8_t>(y + LINE_OFFSET)};  // \（1, 1）
+        table[3][pos] = {static_cast<uint8_t>(x + y), static_cast<uint8_t>(y + LINE_OFFSET)};          // /（1, -1）
+    }
+    return table;
+}
+
+template <int N>
+constexpr std::array<std::array<uint32_t, lineCount(N)>, DIRECTION_COUNT> createLineMaskTable() {
+    std::array<std::array<uint32_t, lineCount(N)>, DIRECTION_COUNT> table{};
+    constexpr auto slots = createLineSlotTable<N>();
+    for (int direction = 0; direction < DIRECTION_COUNT; direction++) {
+        for (int pos = 0; pos < N * N; pos++) {
+            LineSlot slot = slots[direction][pos];
+            table[direction][slot.line] |= 1u << slot.bit;
+        }
+    }
+    return table;
+}
+
+template <int N>
+struct LineBoard {
+    static_assert(N + 2 * LINE_OFFSET <= 32, "每條線必須放得進 uint32_t");
+    static constexpr int BITBOARD_COUNT = Board<N>::BITBOARD_COUNT;
+    static constexpr int LINE_COUNT = lineCount(N);
+    /// 每個方向上每個格子所屬的線與 bit 位置
+    static constexpr auto LINE_SLOT_TABLE = createLineSlotTable<N>();
+    /// 每條線上真正位於棋盤內的 bit，線外（含前後保留位）視為被擋住
+    static constexpr auto LINE_MASK_TABLE = createLineMaskTable<N>();
+
+    uint32_t lines[2][DIRECTION_COUNT][LINE_COUNT];  ///< [顏色 (0 = 黑, 1 = 白)][方向][線]
+
+    void clear() { memset(lines, 0, sizeof(lines)); }
+
+    /**
+     * @brief 從兩個位棋盤建立線編碼（padding bit 會被忽略）
+     */
+    void load(const uint64_t* boardBlack, const uint64_t* boardWhite) {
+        clear();
+        uint64_t black[BITBOARD_COUNT], white[BITBOARD_COUNT];
+        for (int i = 0; i < BITBOARD_COUNT; i++) {
+            black[i] = boardBlack[i] & Board<N>::VALID_MASK[i];
+            white[i] = boardWhite[i] & Board<N>::VALID_MASK[i];
+        }
+        Board<N>::forEachBit(black, [&](int pos) { place(pos, true); });
+        Board<N>::forEachBit(white, [&](int pos) { place(pos, false); });
+    }
+
+    /**
+     * @brief 在 pos 放一顆棋子，更新通過該格的四條線
+     */
+    void place(int pos, bool isBlack) {
+        uint32_t (*own)[LINE_COUNT] = lines[isBlack ? 0 : 1];
+        for (int direction = 0; direction < DIRECTION_COUNT; direction++) {
+            LineSlot slot = LINE_SLOT_TABLE[direction][pos];
+            own[direction][slot.line] |= 1u << slot.bit;
+        }
+    }
+
+    /**
+     * @brief 移除 pos 上的棋子（搜尋中撤銷落子）
+     */
+    void remove(int pos, bool isBlack) {
+        uint32_t (*own)[LINE_COUNT] = lines[isBlack ? 0 : 1];
+        for (int direction = 0; direction < DIRECTION_COUNT; direction++) {
+            LineSlot slot = LINE_SLOT_TABLE[direction][pos];
+            own[direction][slot.line] &= ~(1u << slot.bit);
+        }
+    }
+
+    /**
+     * @brief 取出 pos 在某方向上前後各四格的 9 bit 視窗，pos 本身位於第 4 個 bit
+     */
+    uint32_t window(int pos, int direction, bool isBlack) const {
+        LineSlot slot = LINE_SLOT_TABLE[direction][pos];
+        return (lines[isBlack ? 0 : 1][direction][slot.line] >> (slot.bit - LINE_OFFSET)) & 0x1FF;
+    }
+
+    /**
+     * @brief 與 window 相同的 9 bit 視窗，但標記的是對 isBlack 而言被擋住的格子（對手棋子或棋盤外）
+     */
+    uint32_t blockedWindow(int pos, int direction, bool isBlack) const {
+        LineSlot slot = LINE_SLOT_TABLE[direction][pos];
+        uint32_t blocked = lines[isBlack ? 1 : 0][direction][slot.line] | ~LINE_MASK_TABLE[direction][slot.line];
+        return (blocked >> (slot.bit - LINE_OFFSET)) & 0x1FF;
+    }
+
+    /**
+     * @brief 判斷 pos 上的棋子是否在任一方向連成五顆（或以上）
+     *
+     * 9 bit 視窗中任何長度為 5 的連續段都一定包含中心格，所以一次 mask-and-compare 就等同於
+     * 從 pos 往兩側數棋子。
+     */
+    bool isFive(int pos, bool isBlack) const {
+        for (int direction = 0; direction < DIRECTION_COUNT; direction++) {
+            uint32_t w = window(pos, direction, isBlack);
+            if (w & (w >> 1) & (w >> 2) & (w >> 3) & (w >> 4)) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+#endif  // LINEBOARD_HPP
@@ -2,24 +2,34 @@
 
 #include <stdint.h>
 
+#include <algorithm>
 #include <atomic>
 #include <cassert>
 #include <chrono>
 #include <climits>
 #include <cmath>
 #include <cstdint>
+#include <cstring>
 #include <future>
 #include <iostream>
 #include <limits>
 #include <random>
 #include <set>
 #include <thread>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
 #include "Game.hpp"
+#include "LineBoard.hpp"
 #include "Node.hpp"
+#include "Pattern.hpp"
 #include "ThreadPool.hpp"
+
+#ifdef __GLIBC__
+#include <malloc.h>  // malloc_trim
+#endif
+
 /*
 Todo list:
 1. 調整expansion 拓展範圍，範圍設為方圓一格
@@ -30,252 +40,969 @@ Todo list:
 */
 using namespace std;
 ThreadPool threadPool(5);
-MCTS::MCTS(int simTimes, int numThreads)
-    : simulationTimes(simTimes), numThreads(numThreads), generator(std::random_device{}()) {}
 
-int MCTS::run(Node* root, int iterations) {
+static uint64_t randomSeed() {
+    std::random_device device;
+    return (static_cast<uint64_t>(device()) << 32) | device();
+}
+template <int N>
+MCTS<N>::MCTS(int simTimes, int numThreads, searchMode mode)
+    : numThreads(numThreads),
+      mode(mode),
+      simulationTimes(simTimes),
+      seed(randomSeed()),
+      arenas(numThreads + 1),
+      transpositions(DEFAULT_TRANSPOSITION_ENTRIES) {}
+
+template <int N>
+MCTS<N>::~MCTS() { stopPondering(); }
+
+template <int N>
+void MCTS<N>::setTranspositionTableSize(size_t entries) { transpositions.resize(entries); }
+
+template <int N>
+void MCTS<N>::setNodeBudget(size_t nodes) { nodeBudget = nodes == 0 ? 0 : std::max(nodes, MIN_NODE_BUDGET); }
+
+template <int N>
+void MCTS<N>::setMemoryBudget(size_t bytes) {
+    if (bytes == 0) {
+        setNodeBudget(0);
+        return;
+    }
+    size_t chunkBytes = NodeArena<N>::DEFAULT_CHUNK_CAPACITY * sizeof(Node<N>);
+    size_t fixed = transpositions.memoryUsage() + (arenas.size() + 1) * chunkBytes;
+    setNodeBudget(bytes > fixed ? (bytes - fixed) / sizeof(Node<N>) * 2 / 3 : 1);
+}
+
+template <int N>
+size_t MCTS<N>::memoryUsage() const {
+    size_t bytes = spareArena.reservedBytes() + transpositions.memoryUsage();
+    for (const NodeArena<N>& arena : arenas) {
+        bytes += arena.reservedBytes();
+    }
+    return bytes;
+}
+
+template <int N>
+void MCTS<N>::setSeed(uint64_t seed) {
+    this->seed = seed;
+    nextIteration.store(0, std::memory_order_relaxed);
+}
+
+template <int N>
+void MCTS<N>::startPondering(Node<N>* root) {
+    stopPondering();
+    ponderThread = std::thread([this, root]() { run(root, INT_MAX); });
+}
+
+template <int N>
+void MCTS<N>::stopPondering() {
+    if (!ponderThread.joinable()) {
+        return;
+    }
+    stopRequested.store(true, std::memory_order_relaxed);
+    ponderThread.join();
+    stopRequested.store(false, std::memory_order_relaxed);
+}
+
+template <int N>
+int MCTS<N>::run(Node<N>* root, int iterations) {
     auto start = std::chrono::high_resolution_clock::now();
-    for (int i = 1; i <= iterations; i++) {
-        // if (i % 10000 == 0) {
-        //     cout << "MCTS iteration: " << i << endl << "別急，我在思考中..." << endl;
-        // }
-        Node* selectedNode = selection(root);
-        if (selectedNode->isWin) {
-            backpropagation(selectedNode, root->parent, selectedNode->isBlackTurn, 1);
-            continue;
+    seedRoot(root);
+    // 只有 rootNode 底下的樹可以在搜尋中途壓縮（呼叫端的根節點指標不會改變）
+    pruneWhenFull = nodeBudget > 0 && root == &rootNode && mode != searchMode::ROOT_PARALLEL;
+    if (nodeBudget > 0 && root == &rootNode && treeSize() + Board<N>::CELLS > nodeBudget) {
+        compact(root);
+    }
+    searchStart = Clock::now();
+    searchStartVisits = root->visits.load(std::memory_order_relaxed);
+    clockCheckInterval = std::max(1, CLOCK_CHECK_PLAYOUTS / simulationTimes);
+    deadlineReached.store(false, std::memory_order_relaxed);
+    memoryFull.store(false, std::memory_order_relaxed);
+    INSTRUMENT_ONLY(lastSearch.begin());
+    while (true) {
+        int remaining = iterations - (root->visits.load(std::memory_order_relaxed) - searchStartVisits);
+        if (mode == searchMode::TREE_PARALLEL) {
+            treeParallelSearch(root, remaining);
+        } else if (mode == searchMode::ROOT_PARALLEL) {
+            rootParallelSearch(root, remaining);
+        } else {
+            for (int i = 1; i <= remaining && keepSearching(root, i - 1); i++) {
+                // if (i % 10000 == 0) {
+                //     cout << "MCTS iteration: " << i << endl << "別急，我在思考中..." << endl;
+                // }
+                searchIteration(root, arenas[0], nextIteration.fetch_add(1, std::memory_order_relaxed));
+            }
         }
-        if (selectedNode->visits == 0 || selectedNode->children[0] == nullptr) {
-            selectedNode = expansion(selectedNode);
+        // 節點用完而暫停時，壓縮樹後繼續跑剩下的 iteration；其他原因結束就不再繼續
+        if (!pruneWhenFull || !memoryFull.load(std::memory_order_relaxed) ||
+            stopRequested.load(std::memory_order_relaxed) || deadlineReached.load(std::memory_order_relaxed) ||
+            root->proven.load(std::memory_order_relaxed) != UNPROVEN) {
+            break;
         }
-        double playoutResult = parallelPlayouts(numThreads, simulationTimes, selectedNode);
-        backpropagation(selectedNode, root->parent, selectedNode->isBlackTurn, playoutResult);
+        compact(root);
+        memoryFull.store(false, std::memory_order_relaxed);
     }
+    pruneWhenFull = false;
+    INSTRUMENT_ONLY(lastSearch.end());
     auto end = std::chrono::high_resolution_clock::now();  // 記錄結束時間
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
     return duration.count();
 }
 
-Node* MCTS::selection(Node* node) {
-    while (true) {
-        if (node->children[0] == nullptr) {
-            return node;
-        } else {
-            Node* bestChild = nullptr;
-            double bestValue = std::numeric_limits<double>::lowest();
-            double logParent = log(node->visits);
-            for (int i = 0; i < MAX_CHILDREN && node->children[i] != nullptr; i++) {
-                Node* child = node->children[i];
-                if (child->visits == 0) {
-                    return child;
-                }
-                double ucbValue = (child->wins / child->visits) + COEFFICIENT * sqrt(logParent / child->visits);
-                if (ucbValue > bestValue) {
-                    bestValue = ucbValue;
-                    bestChild = child;
-                }
+template <int N>
+int MCTS<N>::runFor(Node<N>* root, int milliseconds) {
+    seedRoot(root);
+    int startVisits = root->visits.load(std::memory_order_relaxed);
+    deadline = Clock::now() + std::chrono::milliseconds(milliseconds);
+    run(root, INT_MAX);
+    deadline = Clock::time_point::max();
+    return root->visits.load(std::memory_order_relaxed) - startVisits;
+}
+
+template <int N>
+bool MCTS<N>::keepSearching(Node<N>* root, int completed) {
+    if (stopRequested.load(std::memory_order_relaxed) || deadlineReached.load(std::memory_order_relaxed) ||
+        root->proven.load(std::memory_order_relaxed) != UNPROVEN ||
+        (pruneWhenFull && memoryFull.load(std::memory_order_relaxed))) {
+        return false;
+    }
+    if (deadline == Clock::time_point::max() || completed == 0 || completed % clockCheckInterval != 0) {
+        return true;
+    }
+    Clock::time_point now = Clock::now();
+    if (now >= deadline || (mode != searchMode::ROOT_PARALLEL && leaderDecided(root, now))) {
+        deadlineReached.store(true, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+template <int N>
+bool MCTS<N>::leaderDecided(Node<N>* root, Clock::time_point now) {
+    int completed = root->visits.load(std::memory_order_relaxed) - searchStartVisits;
+    if (completed < MIN_EARLY_STOP_VISITS) {
+        return false;
+    }
+    // 以目前為止的搜尋速度估計剩餘時間內還能完成的 iteration 數
+    double elapsed = std::chrono::duration<double>(now - searchStart).count();
+    double remaining = std::chrono::duration<double>(deadline - now).count();
+    double remainingIterations = completed * remaining / elapsed;
+    int best = 0, second = 0;
+    int childCount = root->childCount.load(std::memory_order_acquire);
+    for (int i = 0; i < childCount; i++) {
+        int visits = root->children[i].visits.load(std::memory_order_relaxed);
+        if (visits > best) {
+            second = best;
+            best = visits;
+        } else if (visits > second) {
+            second = visits;
+        }
+    }
+    return best - second > remainingIterations;
+}
+
+template <int N>
+void MCTS<N>::searchIteration(Node<N>* root, NodeArena<N>& arena, uint64_t iteration) {
+    INSTRUMENT_ADD(iterations, 1);
+    Node<N>* path[MAX_PATH];
+    int length;
+    {
+        INSTRUMENT_PHASE(SELECTION);
+        length = selection(root, path);
+    }
+    INSTRUMENT_MAX(maxDepth, length);
+    Node<N>* selectedNode = path[length - 1];
+    // 葉節點第二次被選到才拓展（根節點除外），大多數只走過一次的節點因此不會配置子節點區塊
+    bool expandable =
+        selectedNode->childCount == 0 && (length == 1 || selectedNode->visits.load(std::memory_order_relaxed) > 0);
+    if (selectedNode->proven.load(std::memory_order_relaxed) == UNPROVEN && expandable) {
+        INSTRUMENT_PHASE(EXPANSION);
+        Node<N>* leaf = expansion(selectedNode, arena);
+        if (leaf != selectedNode) {
+            if (mode == searchMode::TREE_PARALLEL) {
+                leaf->virtualLoss.fetch_add(1, std::memory_order_relaxed);
             }
-            node = bestChild;
+            path[length++] = leaf;
+            selectedNode = leaf;
         }
     }
+    // 已證明的葉節點（連五或子節點全部已證明）不需要 playout，直接以證明的結果回傳
+    int8_t proven = selectedNode->proven.load(std::memory_order_relaxed);
+    if (proven != UNPROVEN) {
+        INSTRUMENT_PHASE(BACKPROPAGATION);
+        propagateProof(path, length);
+        backpropagation(path, length, selectedNode->isBlackTurn, proven);
+        return;
+    }
+    double playoutResult;
+    {
+        INSTRUMENT_PHASE(PLAYOUT);
+        if (mode == searchMode::LEAF_PARALLEL) {
+            playoutResult = parallelPlayouts(numThreads, simulationTimes, selectedNode, iteration);
+        } else {
+            // 樹平行與根平行的每個 worker 自己跑完這個葉節點的 playout，不再經過執行緒池
+            int totalResults = runPlayouts(selectedNode, iteration, 0, simulationTimes);
+            playoutResult = static_cast<double>(totalResults) / simulationTimes;
+        }
+    }
+    INSTRUMENT_PHASE(BACKPROPAGATION);
+    backpropagation(path, length, selectedNode->isBlackTurn, playoutResult);
 }
-Node* MCTS::expansion(Node* node) {
-    // 建立所有已佔據位置的合併位棋盤
-    uint64_t combined[BITBOARD_COUNT];
-    static constexpr uint64_t LAST_BOARD_MASK = 0xFFFFFFFE00000000;
-    for (int i = 0; i < BITBOARD_COUNT; i++) {
-        combined[i] = node->boardBlack[i] | node->boardWhite[i];
+
+template <int N>
+void MCTS<N>::treeParallelSearch(Node<N>* root, int iterations) {
+    std::atomic<int> remaining(iterations);
+    auto worker = [this, root, &remaining](int workerId) {
+        NodeArena<N>& arena = arenas[workerId];
+        for (int completed = 0; keepSearching(root, completed) && remaining.fetch_sub(1, std::memory_order_relaxed) > 0;
+             completed++) {
+            searchIteration(root, arena, nextIteration.fetch_add(1, std::memory_order_relaxed));
+        }
+    };
+    runWorkers(worker);
+}
+
+template <int N>
+void MCTS<N>::rootParallelSearch(Node<N>* root, int iterations) {
+    // 先拓展主樹的根節點，合併時各執行緒的根子節點與它一一對應（拓展順序是固定的）
+    expansion(root);
+    if (root->proven.load(std::memory_order_relaxed) != UNPROVEN) {
+        return;
     }
+    int candidates = root->candidateCount;
+    std::vector<Node<N>*> localRoots(numThreads);
+    int quotient = iterations / numThreads;
+    int remainder = iterations % numThreads;
+    // 第 workerId 個執行緒的第 i 個 iteration 編號為 base + i * numThreads + workerId，各執行緒的亂數流互不重疊
+    uint64_t base = nextIteration.load(std::memory_order_relaxed);
+    nextIteration.store(base + static_cast<uint64_t>(quotient + 1) * numThreads, std::memory_order_relaxed);
+    auto worker = [&](int workerId) {
+        // 第 0 個 worker 跑在主執行緒上，各棵樹一律放在 arenas[workerId + 1]，不與主樹共用 arenas[0]
+        NodeArena<N>& arena = arenas[workerId + 1];
+        // 複製根節點的棋盤，但不帶任何子節點與統計
+        Node<N>* localRoot = arena.allocate(1);
+        new (localRoot) Node<N>(*root);
+        localRoot->parent = nullptr;
+        localRoot->children = nullptr;
+        localRoot->childCount = 0;
+        localRoot->candidateCount = 0;
+        localRoot->expanding = false;
+        localRoot->visits = 0;
+        localRoot->wins = 0;
+        localRoot->proven = UNPROVEN;
+        localRoots[workerId] = localRoot;
+        int runTimes = (workerId < remainder) ? quotient + 1 : quotient;
+        for (int i = 0; i < runTimes && keepSearching(localRoot, i); i++) {
+            searchIteration(localRoot, arena, base + static_cast<uint64_t>(i) * numThreads + workerId);
+        }
+    };
+    runWorkers(worker);
 
-    // 準備儲存相鄰空位的位棋盤
-    uint64_t adjacentEmpty[BITBOARD_COUNT] = {0};
+    // 合併各棵樹根子節點的訪問與勝利次數到主樹，任一棵樹證明的子節點在主樹上同樣成立；
+    // 候選著手的先驗順序只由局面決定，各棵樹打開的子節點數不同，主樹打開到最多的那一棵為止
+    for (Node<N>* localRoot : localRoots) {
+        if (localRoot->candidateCount != candidates) {
+            continue;
+        }
+        int childCount = localRoot->childCount;
+        widen(root, childCount);
+        for (int i = 0; i < childCount; i++) {
+            Node<N>* child = &root->children[i];
+            Node<N>* localChild = &localRoot->children[i];
+            assert(child->lastMove.x == localChild->lastMove.x && child->lastMove.y == localChild->lastMove.y);
+            child->visits += localChild->visits;
+            atomicAdd(child->wins, localChild->wins);
+            int8_t expected = UNPROVEN;
+            child->proven.compare_exchange_strong(expected, localChild->proven.load(std::memory_order_relaxed),
+                                                  std::memory_order_relaxed);
+        }
+        root->visits += localRoot->visits;
+        atomicAdd(root->wins, localRoot->wins);
+    }
+    updateProof(root);
+    // 各執行緒的樹（含第 0 個 worker 的）只在本次搜尋中使用，合併後全部回收；主樹只在 arenas[0]
+    for (size_t i = 1; i < arenas.size(); i++) {
+        arenas[i].reset();
+    }
+    recountNodes();
+}
 
-    // 對於每個已佔據的位置，標記其空白的鄰居
-    for (int i = 0; i < BITBOARD_COUNT; i++) {
-        uint64_t occupied = combined[i];
-        if (__builtin_popcountll(occupied) == 0) continue;
-        while (occupied) {
-            // 跳過你提到的特殊情況
-            if (i == 3 && occupied == LAST_BOARD_MASK) {
+template <int N>
+void MCTS<N>::runWorkers(const std::function<void(int)>& worker) {
+    std::vector<std::thread> workers;
+    for (int i = 1; i < numThreads; i++) {
+        workers.emplace_back(worker, i);
+    }
+    worker(0);  // 主線程也是一個 worker
+    for (std::thread& t : workers) {
+        t.join();
+    }
+}
+
+template <int N>
+int MCTS<N>::selection(Node<N>* node, Node<N>** path) {
+    const bool useVirtualLoss = (mode == searchMode::TREE_PARALLEL);
+    if (useVirtualLoss) {
+        node->virtualLoss.fetch_add(1, std::memory_order_relaxed);
+    }
+    int length = 0;
+    path[length++] = node;
+    while (true) {
+        int childCount = node->childCount.load(std::memory_order_acquire);
+        if (childCount == 0) {
+            return length;
+        }
+        // 漸進拓寬：訪問次數夠多時依先驗順序打開下一個候選格，新打開的子節點沒有訪問次數，下面會直接選到它
+        int candidates = node->candidateCount;
+        if (childCount < candidates) {
+            int width = std::min(openWidth(node->visits.load(std::memory_order_relaxed)), candidates);
+            if (width > childCount) {
+                childCount = widen(node, width);
+            }
+        }
+        Node<N>* bestChild = nullptr;
+        double bestValue = std::numeric_limits<double>::lowest();
+        double logParent =
+            log(node->visits.load(std::memory_order_relaxed) + node->virtualLoss.load(std::memory_order_relaxed));
+        bool unvisited = false;
+        for (int i = 0; i < childCount; i++) {
+            Node<N>* child = &node->children[i];
+            // 已證明的子樹結果已知，再搜尋也不會改變
+            if (child->proven.load(std::memory_order_relaxed) != UNPROVEN) {
+                continue;
+            }
+            int virtualLoss = child->virtualLoss.load(std::memory_order_relaxed);
+            int visits = child->visits.load(std::memory_order_relaxed) + virtualLoss;
+            if (visits == 0) {
+                bestChild = child;
+                unvisited = true;
                 break;
             }
-
-            // 找到最低位的 1
-            int pos = __builtin_ctzll(occupied);
-            int globalPos = pos + i * 64;
-            int x = globalLookupTable[globalPos].x;
-            int y = globalLookupTable[globalPos].y;
-
-            // 檢查相鄰位置
-            for (int dx = -1; dx <= 1; dx++) {
-                for (int dy = -1; dy <= 1; dy++) {
-                    int nx = x + dx;
-                    int ny = y + dy;
-
-                    // 跳過超出邊界的座標
-                    if (nx < 0 || nx >= BOARD_SIZE || ny < 0 || ny >= BOARD_SIZE) continue;
-
-                    // 若位置為空，則在 adjacentEmpty 標記
-                    if (!getBit(combined, {nx, ny})) {
-                        setBit(adjacentEmpty, {nx, ny});
-                    }
-                }
+            // 虛擬損失：其他執行緒正在探索的次數先當作輸局計算，讓各執行緒分散到不同分支
+            double ucbValue = (child->wins.load(std::memory_order_relaxed) - virtualLoss) / visits +
+                              COEFFICIENT * sqrt(logParent / visits);
+            if (ucbValue > bestValue) {
+                bestValue = ucbValue;
+                bestChild = child;
             }
+        }
+        if (bestChild == nullptr) {
+            if (childCount < candidates) {
+                // 打開的子節點都已證明，但還有候選格：再打開一個後重新選擇
+                widen(node, childCount + 1);
+                continue;
+            }
+            // 所有子節點都已證明，node 本身也就能被證明，由呼叫端直接回傳證明的結果
+            updateProof(node);
+            return length;
+        }
+        if (useVirtualLoss) {
+            bestChild->virtualLoss.fetch_add(1, std::memory_order_relaxed);
+        }
+        path[length++] = bestChild;
+        if (unvisited) {
+            return length;
+        }
+        node = bestChild;
+    }
+}
+template <int N>
+Node<N>* MCTS<N>::expansion(Node<N>* node) { return expansion(node, arenas[0]); }
+
+template <int N>
+Node<N>* MCTS<N>::expansion(Node<N>* node, NodeArena<N>& arena) {
+    // 同一個節點只允許一個執行緒拓展，其他執行緒直接從該節點做 playout
+    bool expected = false;
+    if (!node->expanding.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+        return node;
+    }
 
-            // 清除最低位的 1
-            occupied &= (occupied - 1);
+    // 同一局面已經由其他著手順序拓展過時，直接共用它的子節點區塊
+    const bool useTranspositions = mode != searchMode::ROOT_PARALLEL;
+    if (useTranspositions) {
+        if (Node<N>* twin = transpositions.lookup(node)) {
+            node->children = twin->children;
+            node->candidateCount = twin->candidateCount;
+            node->childCount.store(twin->childCount.load(std::memory_order_acquire), std::memory_order_release);
+            return firstLeaf(node);
         }
     }
 
-    // 為每個相鄰空位建立子節點
-    int index = 0;
+    // 以整盤位移一次算出所有與棋子相鄰的空位
+    uint64_t adjacentEmpty[BITBOARD_COUNT];
+    Board<N>::emptyNeighbours(node->boardBlack, node->boardWhite, adjacentEmpty);
+
+    // 計算相鄰空位數量，一次配置連續的子節點區塊
+    int count = 0;
     for (int i = 0; i < BITBOARD_COUNT; i++) {
-        uint64_t expandPositions = adjacentEmpty[i];
-        while (expandPositions) {
-            int pos = __builtin_ctzll(expandPositions);
-            int globalPos = pos + i * 64;
-            int x = globalLookupTable[globalPos].x;
-            int y = globalLookupTable[globalPos].y;
+        count += __builtin_popcountll(adjacentEmpty[i]);
+    }
+    if (count == 0) {
+        return node;
+    }
+    size_t allocated = allocatedNodes.fetch_add(count, std::memory_order_relaxed) + count;
+    if (nodeBudget > 0 && allocated > nodeBudget) {
+        // 超過節點上限：放棄拓展並釋出拓展權，壓縮樹之後還可以再拓展
+        allocatedNodes.fetch_sub(count, std::memory_order_relaxed);
+        node->expanding.store(false, std::memory_order_release);
+        memoryFull.store(true, std::memory_order_relaxed);
+        return node;
+    }
+    Node<N>* block = arena.allocate(count);
+
+    // 候選著手依先驗分數排列，只建立一開始就打開的子節點，其餘只記下著手；
+    // 快照收錄的局面一次全部打開，帶入的統計才有對應的子節點
+    int moves[Board<N>::CELLS];
+    rankCandidates(node, adjacentEmpty, moves);
+    const typename TreeSnapshot<N>::SnapshotNode* saved =
+        snapshot != nullptr && useTranspositions ? snapshot->find(node->hash) : nullptr;
+    int open = saved != nullptr ? count : std::min(openWidth(node->visits.load(std::memory_order_relaxed)), count);
+    for (int i = 0; i < open; i++) {
+        new (&block[i]) Node<N>(Board<N>::LOOKUP_TABLE[moves[i]], node);
+    }
+    for (int i = open; i < count; i++) {
+        new (&block[i]) Node<N>(Board<N>::LOOKUP_TABLE[moves[i]]);
+    }
+    INSTRUMENT_ADD(nodesCreated, open);
+    if (saved != nullptr) {
+        seedFromSnapshot(saved, block, count);
+    }
+    node->children = block;
+    node->candidateCount = static_cast<uint16_t>(count);
+    node->childCount.store(open, std::memory_order_release);
+    if (useTranspositions) {
+        transpositions.insert(node);
+    }
+
+    // 返回第一個子節點（有直接連五的子節點時返回它）
+    return firstLeaf(node);
+}
+
+template <int N>
+void MCTS<N>::seedRoot(Node<N>* root) {
+    if (snapshot == nullptr || mode == searchMode::ROOT_PARALLEL || root->visits.load(std::memory_order_relaxed) != 0) {
+        return;
+    }
+    // 新的根節點先帶入快照的統計，選擇時 log(父節點訪問次數) 才會與帶入的子節點統計一致
+    if (const typename TreeSnapshot<N>::SnapshotNode* saved = snapshot->find(root->hash)) {
+        root->visits.store(saved->visits, std::memory_order_relaxed);
+        root->wins.store(saved->wins, std::memory_order_relaxed);
+    }
+}
+
+template <int N>
+void MCTS<N>::seedFromSnapshot(const typename TreeSnapshot<N>::SnapshotNode* saved, Node<N>* block, int count) {
+    // 區塊依先驗分數排列，快照的子節點依格子索引排列，先建立格子到區塊位置的對照
+    int slots[Board<N>::CELLS];
+    std::fill(slots, slots + Board<N>::CELLS, -1);
+    for (int i = 0; i < count; i++) {
+        slots[Board<N>::index(block[i].lastMove)] = i;
+    }
+    // 雜湊碰撞造成對不上的著手直接略過
+    const typename TreeSnapshot<N>::SnapshotNode* children = snapshot->children(saved);
+    for (int j = 0; j < saved->childCount; j++) {
+        int slot = children[j].move < Board<N>::CELLS ? slots[children[j].move] : -1;
+        if (slot < 0) {
+            continue;
+        }
+        block[slot].visits.store(children[j].visits, std::memory_order_relaxed);
+        block[slot].wins.store(children[j].wins, std::memory_order_relaxed);
+        if (children[j].proven != UNPROVEN) {
+            block[slot].proven.store(children[j].proven, std::memory_order_relaxed);
+        }
+    }
+}
+
+template <int N>
+int MCTS<N>::openWidth(int visits) const {
+    if (!progressiveWidening) {
+        return Board<N>::CELLS;
+    }
+    return WIDEN_BASE + static_cast<int>(sqrt(static_cast<double>(visits)));
+}
+
+template <int N>
+int MCTS<N>::widen(Node<N>* node, int target) {
+    uint16_t count = node->childCount.load(std::memory_order_acquire);
+    while (count < target) {
+        Node<N>* child = &node->children[count];
+        uint8_t expected = CHILD_PENDING;
+        if (child->state.compare_exchange_strong(expected, CHILD_BUILDING, std::memory_order_acquire)) {
+            child->materialize(node);
+            child->state.store(CHILD_READY, std::memory_order_release);
+            INSTRUMENT_ADD(nodesCreated, 1);
+        } else {
+            // 共用這個區塊的其他父節點（或同一父節點的其他執行緒）正在建立它，建立只需要幾十奈秒
+            while (child->state.load(std::memory_order_acquire) != CHILD_READY) {
+                std::this_thread::yield();
+            }
+        }
+        // childCount 只會往上加；其他執行緒先打開了這一格時，count 會更新成它發佈的值
+        if (node->childCount.compare_exchange_weak(count, static_cast<uint16_t>(count + 1), std::memory_order_release,
+                                                   std::memory_order_acquire)) {
+            count++;
+        }
+    }
+    return count;
+}
+
+template <int N>
+Node<N>* MCTS<N>::firstLeaf(Node<N>* node) {
+    int childCount = node->childCount.load(std::memory_order_acquire);
+    for (int i = 0; i < childCount; i++) {
+        if (node->children[i].proven.load(std::memory_order_relaxed) == PROVEN_WIN) {
+            int8_t expected = UNPROVEN;
+            node->proven.compare_exchange_strong(expected, PROVEN_LOSS, std::memory_order_relaxed);
+            return &node->children[i];
+        }
+    }
+    return &node->children[0];
+}
+
+template <int N>
+bool MCTS<N>::updateProof(Node<N>* node) {
+    if (node->proven.load(std::memory_order_relaxed) != UNPROVEN) {
+        return true;
+    }
+    int childCount = node->childCount.load(std::memory_order_acquire);
+    if (childCount == 0) {
+        return false;
+    }
+    // 輪到的一方只要有一個必勝的著手，落下 lastMove 的一方就必敗；所有著手都必敗時則必勝，
+    // 還有沒打開的候選格時無法確定所有著手都必敗
+    int8_t status = childCount == node->candidateCount ? PROVEN_WIN : UNPROVEN;
+    for (int i = 0; i < childCount; i++) {
+        int8_t child = node->children[i].proven.load(std::memory_order_relaxed);
+        if (child == PROVEN_WIN) {
+            status = PROVEN_LOSS;
+            break;
+        }
+        if (child == UNPROVEN) {
+            status = UNPROVEN;
+        }
+    }
+    if (status == UNPROVEN) {
+        return false;
+    }
+    int8_t expected = UNPROVEN;
+    node->proven.compare_exchange_strong(expected, status, std::memory_order_relaxed);
+    return true;
+}
 
-            node->children[index++] = new Node({x, y}, node);
+template <int N>
+void MCTS<N>::propagateProof(Node<N>** path, int length) {
+    for (int i = length - 2; i >= 0 && updateProof(path[i]); i--) {
+    }
+}
 
-            // 清除最低位的 1
-            expandPositions &= (expandPositions - 1);
+template <int N>
+Node<N>* MCTS<N>::bestChild(Node<N>* root) const {
+    Node<N>* best = nullptr;
+    int mostVisits = -1;
+    bool bestLost = true;
+    for (int i = 0; i < root->childCount; i++) {
+        Node<N>* child = &root->children[i];
+        int8_t proven = child->proven.load(std::memory_order_relaxed);
+        if (proven == PROVEN_WIN) {
+            return child;
+        }
+        bool lost = proven == PROVEN_LOSS;
+        int visits = child->visits.load(std::memory_order_relaxed);
+        // 未被證明必敗的著手一律優先於必敗的著手
+        if ((bestLost && !lost) || (bestLost == lost && visits > mostVisits)) {
+            best = child;
+            mostVisits = visits;
+            bestLost = lost;
         }
     }
+    return best;
+}
 
-    // 返回第一個子節點，若無則返回 node
-    return index > 0 ? node->children[0] : node;
+template <int N>
+Node<N>* MCTS<N>::createRoot() {
+    new (&rootNode) Node<N>();
+    return &rootNode;
 }
 
-void MCTS::backpropagation(Node* node, Node* endNode, bool isXTurn, double win) {
-    while (node != endNode) {
-        node->visits++;
+template <int N>
+Node<N>* MCTS<N>::advanceRoot(Node<N>* root, Position move) {
+    Node<N>* next = nullptr;
+    for (int i = 0; i < root->childCount; i++) {
+        if (root->children[i].lastMove.x == move.x && root->children[i].lastMove.y == move.y) {
+            next = &root->children[i];
+            break;
+        }
+    }
+    // 如果落子不在拓展的節點中，則以只含這一步的新區塊取代原本的子節點
+    if (next == nullptr) {
+        next = arenas[0].allocate(1);
+        new (next) Node<N>(move, root);
+        root->children = next;
+        root->candidateCount = 1;
+        root->childCount = 1;
+        root->expanding = true;
+    }
+    compact(next);
+    return &rootNode;
+}
+
+template <int N>
+void MCTS<N>::compact(const Node<N>* source) {
+    int minVisits = nodeBudget > 0 ? pruneThreshold(source, nodeBudget / 2) : 0;
+    // source 可能就是 rootNode 本身，先複製一份再覆寫
+    Node<N> root(*source);
+    // 只把保留的子樹複製到備用 arena，其餘節點隨舊 arena 一起回收；
+    // 置換表裡的指標全部失效，複製時順便重建，並藉此保留子樹內共用的區塊
+    transpositions.clear();
+    new (&rootNode) Node<N>(root);
+    rootNode.parent = nullptr;
+    copyChildren(&root, &rootNode, std::min(minVisits, root.visits.load(std::memory_order_relaxed)));
+    arenas[0].swap(spareArena);
+    spareArena.reset();
+    for (size_t i = 1; i < arenas.size(); i++) {
+        arenas[i].reset();
+    }
+    // 有記憶體上限時把用不到的 chunk 還給系統，否則保留給之後的配置重用
+    if (nodeBudget > 0) {
+        for (NodeArena<N>& arena : arenas) {
+            arena.shrink();
+        }
+        spareArena.shrink();
+#ifdef __GLIBC__
+        // glibc 釋放大區塊後會調高 mmap 門檻，之後的 chunk 改從 heap 配置、釋放時不會還給系統
+        malloc_trim(0);
+#endif
+    }
+    recountNodes();
+}
+
+template <int N>
+void MCTS<N>::copyChildren(const Node<N>* source, Node<N>* target, int minVisits) {
+    if (source->childCount == 0) {
+        return;
+    }
+    if (Node<N>* twin = transpositions.lookup(target)) {
+        target->children = twin->children;
+        target->candidateCount = twin->candidateCount;
+        target->childCount = twin->childCount.load(std::memory_order_relaxed);
+        return;
+    }
+    if (source->visits < minVisits) {
+        // 回收訪問次數少的子樹：統計留在 target，之後被選到時再重新拓展
+        target->children = nullptr;
+        target->childCount = 0;
+        target->candidateCount = 0;
+        target->expanding = false;
+        return;
+    }
+    // 已建立的子節點連同子樹複製，還沒打開的候選格只複製著手
+    int built = source->builtChildren();
+    Node<N>* block = spareArena.allocate(source->candidateCount);
+    target->children = block;
+    target->childCount = built;
+    transpositions.insert(target);
+    for (int i = 0; i < built; i++) {
+        new (&block[i]) Node<N>(source->children[i]);
+        block[i].parent = target;
+        copyChildren(&source->children[i], &block[i], minVisits);
+    }
+    for (int i = built; i < source->candidateCount; i++) {
+        new (&block[i]) Node<N>(source->children[i].lastMove);
+    }
+}
+
+template <int N>
+int MCTS<N>::pruneThreshold(const Node<N>* root, size_t target) const {
+    // 每個子節點區塊只算一次，置換表共用的區塊取所有父節點中最多的訪問次數
+    std::unordered_map<const Node<N>*, std::pair<int, int>> blocks;  // 區塊 → (父節點訪問次數, 區塊大小)
+    std::vector<const Node<N>*> stack = {root};
+    while (!stack.empty()) {
+        const Node<N>* node = stack.back();
+        stack.pop_back();
+        int childCount = node->builtChildren();
+        if (childCount == 0) {
+            continue;
+        }
+        int visits = node->visits.load(std::memory_order_relaxed);
+        auto [block, inserted] = blocks.try_emplace(node->children, visits, node->candidateCount);
+        if (!inserted) {
+            block->second.first = std::max(block->second.first, visits);
+            continue;
+        }
+        for (int i = 0; i < childCount; i++) {
+            stack.push_back(&node->children[i]);
+        }
+    }
+    std::vector<std::pair<int, int>> sorted;
+    sorted.reserve(blocks.size());
+    for (const auto& [children, block] : blocks) {
+        sorted.push_back(block);
+    }
+    std::sort(sorted.begin(), sorted.end(), std::greater<>());
+    // 依父節點訪問次數由多到少保留區塊，第一個放不下的區塊（以及訪問次數不比它多的）全部回收
+    size_t kept = 1;
+    for (const auto& [visits, size] : sorted) {
+        if (kept + size > target) {
+            return visits + 1;
+        }
+        kept += size;
+    }
+    return 0;
+}
+
+template <int N>
+void MCTS<N>::recountNodes() {
+    size_t nodes = spareArena.size();
+    for (const NodeArena<N>& arena : arenas) {
+        nodes += arena.size();
+    }
+    allocatedNodes.store(nodes, std::memory_order_relaxed);
+}
+
+template <int N>
+void MCTS<N>::backpropagation(Node<N>** path, int length, bool isXTurn, double win) {
+    const bool useVirtualLoss = (mode == searchMode::TREE_PARALLEL);
+    for (int i = 0; i < length; i++) {
+        Node<N>* node = path[i];
+        node->visits.fetch_add(1, std::memory_order_relaxed);
         if (isXTurn == node->isBlackTurn) {
-            node->wins += win;
+            atomicAdd(node->wins, win);
         } else {
-            node->wins -= win;
+            atomicAdd(node->wins, -win);
+        }
+        if (useVirtualLoss) {
+            node->virtualLoss.fetch_sub(1, std::memory_order_relaxed);
         }
-        node = node->parent;
     }
 }
 
-int MCTS::playout(Node* node) {
+template <int N>
+int MCTS<N>::runPlayouts(Node<N>* node, uint64_t iteration, int firstSlot, int count) {
+    int totalResults = 0;
+    int slot = firstSlot;
+    const int end = firstSlot + count;
+    if (batchKernel != nullptr && policy == playoutPolicy::RANDOM_PLAYOUT) {
+        static_assert(PLAYOUT_BATCH == 4, "下面的亂數流初始化假設一批四局");
+        for (; slot < end; slot += PLAYOUT_BATCH) {
+            PlayoutRng rngs[PLAYOUT_BATCH] = {PlayoutRng(seed, iteration, slot), PlayoutRng(seed, iteration, slot + 1),
+                                              PlayoutRng(seed, iteration, slot + 2),
+                                              PlayoutRng(seed, iteration, slot + 3)};
+            int batch = std::min(PLAYOUT_BATCH, end - slot);
+            INSTRUMENT_ADD(playouts, batch);
+            totalResults += batchKernel(node, rngs, batch);
+        }
+        return totalResults;
+    }
+    for (; slot < end; slot++) {
+        PlayoutRng rng(seed, iteration, slot);
+        totalResults += playout(node, rng);
+    }
+    return totalResults;
+}
+
+template <int N>
+int MCTS<N>::playout(Node<N>* node, PlayoutRng& rng) {
+    INSTRUMENT_ADD(playouts, 1);
+    return policy == playoutPolicy::PATTERN_PLAYOUT ? patternPlayout(node, rng) : randomPlayout(node, rng);
+}
+
+template <int N>
+int MCTS<N>::randomPlayout(Node<N>* node, PlayoutRng& rng) {
     bool startTurn = node->isBlackTurn;
     bool currentTurn = startTurn;
-    thread_local std::mt19937 localRng(std::random_device{}());
-    int minRow = BOARD_SIZE, maxRow = -1, minCol = BOARD_SIZE, maxCol = -1;
     uint64_t boardBlack[BITBOARD_COUNT];
     uint64_t boardWhite[BITBOARD_COUNT];
     memcpy(boardBlack, node->boardBlack, sizeof(uint64_t) * BITBOARD_COUNT);
     memcpy(boardWhite, node->boardWhite, sizeof(uint64_t) * BITBOARD_COUNT);
-    Position possibleMoves[MAX_CHILDREN] = {0};
+    // 線編碼隨每一步增量更新，勝負判斷只看通過落點的四條線
+    LineBoard<N> lineBoard;
+    lineBoard.load(boardBlack, boardWhite);
+    // 候選落點：一開始是所有與棋子相鄰的空位，之後隨每一步加入新的相鄰空位
+    uint64_t candidates[BITBOARD_COUNT];
+    Board<N>::emptyNeighbours(boardBlack, boardWhite, candidates);
+    int possibleMoves[Board<N>::CELLS];
     int moveCount = 0;
-    bool moveUsed[BOARD_SIZE * BOARD_SIZE] = {false};
-    auto addPossibleMove = [&](int x, int y) {
-        if (x < 0 || x >= BOARD_SIZE || y < 0 || y >= BOARD_SIZE) return;
-        uint64_t key = x * BOARD_SIZE + y;
-        if (!moveUsed[key] && !getBit(boardBlack, {x, y}) && !getBit(boardWhite, {x, y})) {
-            possibleMoves[moveCount++] = {x, y};
-            moveUsed[key] = true;
-        }
-    };
-    for (int i = 0; i < BOARD_SIZE; i++) {
-        for (int j = 0; j < BOARD_SIZE; j++) {
-            if (getBit(boardBlack, {i, j}) || getBit(boardWhite, {i, j})) {
-                minRow = std::min(minRow, i);
-                maxRow = std::max(maxRow, i);
-                minCol = std::min(minCol, j);
-                maxCol = std::max(maxCol, j);
-            }
-        }
-    }
-    // 设置一个边界，确保不会超出棋盘范围
-    const int margin = 1;  // 你可以根据需要调整这个值
-    minRow = std::max(minRow - margin, 0);
-    maxRow = std::min(maxRow + margin, BOARD_SIZE - 1);
-    minCol = std::max(minCol - margin, 0);
-    maxCol = std::min(maxCol + margin, BOARD_SIZE - 1);
-    for (int i = minRow; i <= maxRow; i++) {
-        for (int j = minCol; j <= maxCol; j++) {
-            if (!getBit(boardBlack, {i, j}) && !getBit(boardWhite, {i, j})) {
-                addPossibleMove(i, j);
-            }
-        }
-    }
+    Board<N>::forEachBit(candidates, [&](int pos) { possibleMoves[moveCount++] = pos; });
     if (moveCount == 0) {
         return 0;
     }
     const int MAX_DEEP = 50;
     for (int step = 0; step < moveCount && step < MAX_DEEP; step++) {
-        int randomIndex = step + (localRng() % (moveCount - step));
+        int randomIndex = step + (rng() % (moveCount - step));
         std::swap(possibleMoves[step], possibleMoves[randomIndex]);
 
         currentTurn = !currentTurn;
-        Position move = possibleMoves[step];
+        int pos = possibleMoves[step];
+        INSTRUMENT_ADD(playoutMoves, 1);
 
         // 執行移動
         if (currentTurn) {
-            setBit(boardBlack, move);
+            setBit(boardBlack, pos);
         } else {
-            setBit(boardWhite, move);
+            setBit(boardWhite, pos);
         }
+        lineBoard.place(pos, currentTurn);
 
         // 檢查是否獲勝
-        if (Game::checkWin(move, boardBlack, boardWhite, currentTurn)) {
+        if (lineBoard.isFive(pos, currentTurn)) {
             return (currentTurn == startTurn) ? 1 : -1;
         }
 
-        // 基於最後一次移動添加新的可能移動
-        // 當 move 在 x 軸觸碰邊界時
-        if (move.x == minRow && minRow != 0) {
-            minRow--;
-            for (int col = minCol; col <= maxCol; col++) {
-                addPossibleMove(minRow, col);
-            }
-        } else if (move.x == maxRow && maxRow != BOARD_SIZE - 1) {
-            maxRow++;
-            for (int col = minCol; col <= maxCol; col++) {
-                addPossibleMove(maxRow, col);
-            }
+        // 基於最後一次移動，把尚未列入候選的相鄰空位加入
+        const BitboardMask<N>& neighbours = Board<N>::NEIGHBOUR_TABLE[pos];
+        uint64_t added[BITBOARD_COUNT];
+        for (int i = 0; i < BITBOARD_COUNT; i++) {
+            added[i] = neighbours[i] & ~(boardBlack[i] | boardWhite[i] | candidates[i]);
+            candidates[i] |= added[i];
         }
-        // 當 move 在 y 軸觸碰邊界時
-        if (move.y == minCol && minCol != 0) {
-            minCol--;
-            for (int row = minRow; row <= maxRow; row++) {
-                addPossibleMove(row, minCol);
+        Board<N>::forEachBit(added, [&](int newPos) { possibleMoves[moveCount++] = newPos; });
+    }
+    return 0;
+}
+// 加權抽樣時各棋型的分數：進攻是自己在該點落子形成的棋型，防守是對手在該點落子會形成的棋型
+static constexpr int ATTACK_WEIGHT[] = {0, 2, 6, 10, 60, 80, 1000, 0};
+static constexpr int DEFENCE_WEIGHT[] = {0, 1, 3, 5, 40, 50, 500, 0};
+
+template <int N>
+int MCTS<N>::patternPlayout(Node<N>* node, PlayoutRng& rng) {
+    bool startTurn = node->isBlackTurn;
+    bool currentTurn = startTurn;
+    uint64_t boardBlack[BITBOARD_COUNT];
+    uint64_t boardWhite[BITBOARD_COUNT];
+    memcpy(boardBlack, node->boardBlack, sizeof(uint64_t) * BITBOARD_COUNT);
+    memcpy(boardWhite, node->boardWhite, sizeof(uint64_t) * BITBOARD_COUNT);
+    LineBoard<N> lineBoard;
+    lineBoard.load(boardBlack, boardWhite);
+    uint64_t candidates[BITBOARD_COUNT];
+    Board<N>::emptyNeighbours(boardBlack, boardWhite, candidates);
+    int possibleMoves[Board<N>::CELLS];
+    int weights[Board<N>::CELLS];
+    int moveCount = 0;
+    Board<N>::forEachBit(candidates, [&](int pos) { possibleMoves[moveCount++] = pos; });
+
+    const int MAX_DEEP = 50;
+    for (int step = 0; step < MAX_DEEP && moveCount > 0; step++) {
+        currentTurn = !currentTurn;
+        // 依序檢查：自己能連五就直接下；對手下一步能連五就必須擋；否則依分數加權抽樣
+        int winIndex = -1, blockIndex = -1, totalWeight = 0;
+        for (int i = 0; i < moveCount && winIndex < 0; i++) {
+            int pos = possibleMoves[i];
+            int weight = 1;
+            for (int direction = 0; direction < DIRECTION_COUNT; direction++) {
+                PatternType attack = patternAt(lineBoard, pos, direction, currentTurn);
+                PatternType defence = patternAt(lineBoard, pos, direction, !currentTurn);
+                if (attack == PATTERN_FIVE) {
+                    winIndex = i;
+                    break;
+                }
+                if (defence == PATTERN_FIVE) {
+                    blockIndex = i;
+                }
+                weight += ATTACK_WEIGHT[attack] + DEFENCE_WEIGHT[defence];
             }
-        } else if (move.y == maxCol && maxCol != BOARD_SIZE - 1) {
-            maxCol++;
-            for (int row = minRow; row <= maxRow; row++) {
-                addPossibleMove(row, maxCol);
+            weights[i] = weight;
+            totalWeight += weight;
+        }
+        int chosen;
+        if (winIndex >= 0) {
+            INSTRUMENT_ADD(playoutMoves, 1);
+            return (currentTurn == startTurn) ? 1 : -1;
+        } else if (blockIndex >= 0) {
+            chosen = blockIndex;
+        } else {
+            int r = static_cast<int>(rng() % totalWeight);
+            chosen = 0;
+            while (r >= weights[chosen]) {
+                r -= weights[chosen++];
             }
         }
+
+        int pos = possibleMoves[chosen];
+        possibleMoves[chosen] = possibleMoves[--moveCount];
+        INSTRUMENT_ADD(playoutMoves, 1);
+        if (currentTurn) {
+            setBit(boardBlack, pos);
+        } else {
+            setBit(boardWhite, pos);
+        }
+        lineBoard.place(pos, currentTurn);
+
+        const BitboardMask<N>& neighbours = Board<N>::NEIGHBOUR_TABLE[pos];
+        uint64_t added[BITBOARD_COUNT];
+        for (int i = 0; i < BITBOARD_COUNT; i++) {
+            added[i] = neighbours[i] & ~(boardBlack[i] | boardWhite[i] | candidates[i]);
+            candidates[i] |= added[i];
+        }
+        Board<N>::forEachBit(added, [&](int newPos) { possibleMoves[moveCount++] = newPos; });
     }
     return 0;
 }
-double MCTS::parallelPlayouts(int thread, int simulationTimes, Node* node) {
+
+template <int N>
+int MCTS<N>::rankCandidates(const Node<N>* node, const uint64_t* candidates, int* moves) {
+    // 輪到的一方：自己能連五的著手最優先，其次是擋住對手連五的著手，其餘依 pattern playout 的攻守分數
+    constexpr uint32_t WIN_PRIOR = 1u << 20;
+    constexpr uint32_t BLOCK_PRIOR = 1u << 19;
+    constexpr int INDEX_BITS = 9;
+    static_assert(Board<N>::CELLS <= (1 << INDEX_BITS), "格子索引必須放得進排序鍵的低位");
+    bool isBlack = !node->isBlackTurn;
+    LineBoard<N> lineBoard;
+    lineBoard.load(node->boardBlack, node->boardWhite);
+    // 排序鍵：高位是分數，低位是反轉的格子索引，由大到小排序即為分數高者優先、同分時索引小者優先
+    uint32_t keys[Board<N>::CELLS];
+    int count = 0;
+    Board<N>::forEachBit(candidates, [&](int pos) {
+        uint32_t prior = 1;
+        for (int direction = 0; direction < DIRECTION_COUNT; direction++) {
+            PatternType attack = patternAt(lineBoard, pos, direction, isBlack);
+            PatternType defence = patternAt(lineBoard, pos, direction, !isBlack);
+            if (attack == PATTERN_FIVE) {
+                prior |= WIN_PRIOR;
+            } else if (defence == PATTERN_FIVE) {
+                prior |= BLOCK_PRIOR;
+            }
+            prior += ATTACK_WEIGHT[attack] + DEFENCE_WEIGHT[defence];
+        }
+        keys[count++] = (prior << INDEX_BITS) | ((1u << INDEX_BITS) - 1 - pos);
+    });
+    std::sort(keys, keys + count, std::greater<uint32_t>());
+    for (int i = 0; i < count; i++) {
+        moves[i] = static_cast<int>((1u << INDEX_BITS) - 1 - (keys[i] & ((1u << INDEX_BITS) - 1)));
+    }
+    return count;
+}
+
+template <int N>
+void MCTS<N>::runPlayoutJob(void* argument) {
+    PlayoutJob* job = static_cast<PlayoutJob*>(argument);
+    job->result = job->mcts->runPlayouts(job->node, job->iteration, job->firstSlot, job->runTimes);
+    job->remaining->fetch_sub(1, std::memory_order_release);
+}
+
+template <int N>
+double MCTS<N>::parallelPlayouts(int thread, int simulationTimes, Node<N>* node, uint64_t iteration) {
     assert(thread <= 6 && "Thread count must not exceed 6");
-    std::future<int> futures[8];
+    PlayoutJob jobs[8];  // 工作放在堆疊上，提交給執行緒池時不需要配置
+    std::atomic<int> remaining(thread - 1);
     int quotient = simulationTimes / thread;
     int remainder = simulationTimes % thread;
+    int slot = 0;  // 每個 playout 在這個 iteration 內的編號，決定它的亂數流
     for (int i = 0; i < thread - 1; i++) {  // 最後一個 thread 不用 給主線程執行
         int runTimes = (i < remainder) ? quotient + 1 : quotient;
-        // 把每個執行的 future 存到 vector
-        futures[i] = threadPool.enqueue([this, runTimes, node]() {
-            int results = 0;
-            for (int j = 0; j < runTimes; j++) {
-                results += this->playout(node);
-            }
-            return results;
-        });
+        jobs[i] = {this, node, iteration, slot, runTimes, 0, &remaining};
+        slot += runTimes;
+        threadPool.submit({&MCTS::runPlayoutJob, &jobs[i]});
     }
     // 主線程執行
-    int totalResults = 0;
-    for (int i = 0; i < quotient; i++) {
-        totalResults += playout(node);
-    }
+    int totalResults = runPlayouts(node, iteration, slot, quotient);
+    threadPool.wait(remaining);
     for (int i = 0; i < thread - 1; i++) {  // 最後一個 thread 不用 給主線程執行
-        totalResults += futures[i].get();
+        totalResults += jobs[i].result;
     }
     return static_cast<double>(totalResults) / simulationTimes;
 }
+
+template class MCTS<9>;
+template class MCTS<15>;
+template class MCTS<19>;
@@ -1,28 +1,278 @@
 #ifndef MCTS_HPP
 #define MCTS_HPP
-#include <random>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <vector>
 
+#include "BatchPlayout.hpp"
+#include "Instrument.hpp"
 #include "Node.hpp"
-struct Node;
-struct BoardScore;
+#include "NodeArena.hpp"
+#include "Random.hpp"
+#include "TranspositionTable.hpp"
+#include "TreeSnapshot.hpp"
+/**
+ * @brief 平行化方式
+ *
+ * - LEAF_PARALLEL：單執行緒做選擇/拓展/回傳，只有 playout 分給執行緒池
+ * - TREE_PARALLEL：每個執行緒各自完整跑 選擇/拓展/playout/回傳，共用同一棵樹，以虛擬損失分散探索
+ * - ROOT_PARALLEL：每個執行緒從同一個根節點建立自己獨立的樹與亂數流，結束時把根的子節點統計合併
+ */
+enum searchMode { LEAF_PARALLEL = 1, TREE_PARALLEL = 2, ROOT_PARALLEL = 3 };
+/**
+ * @brief playout 的走子策略
+ *
+ * - RANDOM_PLAYOUT：在候選位置中均勻隨機落子
+ * - PATTERN_PLAYOUT：依棋型表必下連五、必擋對手的四，其餘依攻守分數加權抽樣
+ */
+enum playoutPolicy { RANDOM_PLAYOUT = 1, PATTERN_PLAYOUT = 2 };
+/**
+ * @brief N x N 棋盤的蒙地卡羅樹搜尋
+ *
+ * 樣板只在 MCTS.cpp 中對支援的棋盤大小（9、15、19）明確實例化，每種大小的位棋盤長度、
+ * 遮罩與查表都是編譯期常數。
+ */
+template <int N>
 class MCTS {
    public:
-    MCTS(int simTimes, int numThreads);   // 構造函數聲明
-    int run(Node* root, int iterations);  // run 方法聲明
-    Node* expansion(Node* node);          // expansion 方法聲明
+    MCTS(int simTimes, int numThreads, searchMode mode = LEAF_PARALLEL);  // 構造函數聲明
+    ~MCTS();
+    /**
+     * @brief 從 root 搜尋 iterations 次（MCTS-Solver）
+     *
+     * 證明狀態會沿著選擇路徑往根傳遞，選擇時略過已證明的子樹；根節點一旦被證明就立即結束，
+     * 已知結果的局面因此不會再浪費任何 iteration。
+     *
+     * @return int 耗費的毫秒數
+     */
+    int run(Node<N>* root, int iterations);
+    /**
+     * @brief 以時間為預算的搜尋：持續搜尋直到 milliseconds 毫秒用完
+     *
+     * 若根節點訪問次數最多的子節點，領先第二名的次數已經超過剩餘時間內預估還能跑的 iteration 數，
+     * 最終選擇不可能再改變，就提早結束（根平行模式各執行緒的樹要到最後才合併，只看時間）。
+     * 根節點尚未證明時至少會完成一次 iteration。
+     *
+     * @return int 實際完成的 iteration 數
+     */
+    int runFor(Node<N>* root, int milliseconds);
+    Node<N>* expansion(Node<N>* node);  // expansion 方法聲明
+    /**
+     * @brief 在搜尋自己的 arena 中建立空棋盤的根節點
+     */
+    Node<N>* createRoot();
+    /**
+     * @brief 以 move 推進根節點，並一次回收其他分支
+     *
+     * 在 root 的子節點中找到 move（找不到就新建），把該子樹複製到備用 arena 後整個換掉舊 arena，
+     * 被捨棄的兄弟子樹因此不需要逐一走訪或釋放。
+     *
+     * @return Node<N>* 新的根節點；呼叫後舊樹上的所有指標都會失效
+     */
+    Node<N>* advanceRoot(Node<N>* root, Position move);
+    /**
+     * @brief 搜尋後要下的子節點：已證明必勝者優先，否則取未被證明必敗、訪問次數最多者
+     *
+     * 所有子節點都必敗時仍回傳訪問次數最多的一個；root 沒有子節點時回傳 nullptr。
+     */
+    Node<N>* bestChild(Node<N>* root) const;
+    void setPlayoutPolicy(playoutPolicy policy) { this->policy = policy; }
+    /**
+     * @brief 是否允許隨機 playout 使用 SIMD 批次 kernel（預設開啟，CPU 不支援時永遠使用純量版本）
+     *
+     * 兩種 kernel 的走子分佈相同，但消耗亂數的方式不同，比較結果或重現對局時必須使用同一種。
+     */
+    void setBatchedPlayouts(bool enabled) { batchKernel = enabled ? batchPlayoutKernel<N>() : nullptr; }
+    /**
+     * @brief 是否以漸進拓寬 (progressive widening) 逐步打開子節點（預設開啟）
+     *
+     * 拓展時候選著手依先驗分數（連五、擋連五，其餘為 pattern playout 的攻守分數）排序，
+     * 只打開前 WIDEN_BASE 個；父節點訪問 n 次後最多打開 WIDEN_BASE + sqrt(n) 個，其餘候選格的棋盤要到打開時才建立。
+     * 已打開的子節點全部證明後，即使還沒到訪問次數也會再打開下一個。關閉時拓展就打開所有候選著手。
+     */
+    void setProgressiveWidening(bool enabled) { progressiveWidening = enabled; }
+    /**
+     * @brief 設定置換表的 entry 數量（0 表示停用，不同著手順序的相同局面就不再共用子樹）
+     */
+    void setTranspositionTableSize(size_t entries);
+    /**
+     * @brief 以先前存下的搜尋樹快照暖啟動（nullptr 表示不使用），快照必須在搜尋期間保持開啟
+     *
+     * 拓展快照中收錄的局面時，新建子節點直接帶入快照的訪問次數、勝利次數與證明狀態，
+     * 還沒有統計的根節點在搜尋開始時也一併帶入，因此只有搜尋實際走到的節點才會讀取快照。
+     * 根平行模式各執行緒的樹會在結束時合併，帶入的統計會被重複計算，所以不使用快照。
+     */
+    void setSnapshot(const TreeSnapshot<N>* snapshot) { this->snapshot = snapshot; }
+    /**
+     * @brief 限制搜尋樹的節點數（0 表示不限制，其他值至少為格子數的 4 倍）
+     *
+     * 拓展會超過上限時就放棄這次拓展，搜尋暫停並壓縮整棵樹：訪問次數最少的節點只保留自身的統計，
+     * 子樹整個回收（之後再被選到時重新拓展），直到節點數降到上限的一半，然後繼續搜尋剩下的 iteration。
+     * 推進根節點時保留的子樹也壓縮到同樣的大小，並把多餘的 chunk 還給系統。
+     * 根平行模式各執行緒的樹只存在於一次搜尋中，達到上限時只停止拓展，搜尋開始前才壓縮主樹。
+     */
+    void setNodeBudget(size_t nodes);
+    /**
+     * @brief 以位元組設定搜尋的記憶體上限（0 表示不限制）
+     *
+     * 扣掉置換表與每個 arena 一個 chunk 的零頭後換算成節點上限；壓縮時新舊兩棵樹同時存在，
+     * 舊樹最多到上限、新樹最多到上限的一半，所以節點上限取剩餘空間的 2/3。
+     */
+    void setMemoryBudget(size_t bytes);
+    /// @brief 目前搜尋樹的節點數
+    size_t treeSize() const { return allocatedNodes.load(std::memory_order_relaxed); }
+    /**
+     * @brief 搜尋樹（各 arena 向系統要的 chunk）與置換表佔用的位元組數，不可在搜尋進行中呼叫
+     */
+    size_t memoryUsage() const;
+    /**
+     * @brief 以固定種子重現搜尋（預設種子取自 random_device），並把 iteration 編號歸零
+     *
+     * 每次 playout 的亂數流只由 (種子, iteration 編號, 該 iteration 內的 playout 編號) 決定，與執行緒無關。
+     * 葉平行與根平行在相同種子、相同執行緒數與相同的 run 呼叫序列下會長出逐位元相同的樹；
+     * 樹平行的執行緒交錯取決於排程，只保證個別 playout 可重現。
+     * 批次與純量 playout kernel 的亂數用法不同，重現時也必須使用同一種（見 setBatchedPlayouts）。
+     * runFor 與 pondering 跑多少 iteration 取決於時間，不在保證範圍內。
+     */
+    void setSeed(uint64_t seed);
+    /**
+     * @brief 在背景執行緒從 root 持續搜尋（等待對手落子時使用），直到呼叫 stopPondering
+     *
+     * 背景搜尋期間不可呼叫其他會修改搜尋樹的方法。
+     */
+    void startPondering(Node<N>* root);
+    /**
+     * @brief 停止背景搜尋並等待它結束，之後即可以對手的落子呼叫 advanceRoot 沿用對應子樹
+     */
+    void stopPondering();
+#ifdef GOMOKU_INSTRUMENT
+    /**
+     * @brief 輸出最近一次 run / runFor 的量測報表（僅在 GOMOKU_INSTRUMENT 版本中提供）
+     */
+    void printInstrumentation(std::ostream& out) const { instrument::printReport(out, lastSearch); }
+#endif
 
    private:
+    template <int>
+    friend struct MCTSBenchmark;  ///< bench/Benchmark.cpp 直接量測 playout、selection 等內部步驟
+    static constexpr int BITBOARD_COUNT = Board<N>::BITBOARD_COUNT;
     int numThreads;
+    searchMode mode;
+    playoutPolicy policy = playoutPolicy::RANDOM_PLAYOUT;
+    BatchPlayoutKernel<N> batchKernel = batchPlayoutKernel<N>();  ///< nullptr 表示逐局執行純量 playout
     const double COEFFICIENT = 1.414;
+    static constexpr int WIDEN_BASE = 2;  ///< 漸進拓寬一開始打開的子節點數
+    bool progressiveWidening = true;      ///< 見 setProgressiveWidening
     const int MAX_DEEP = 50;
     int simulationTimes;
     inline static const Position direction[8] = {{1, 0}, {0, 1}, {1, 1}, {1, -1}, {-1, 0}, {0, -1}, {-1, -1}, {-1, 1}};
 
-    std::mt19937 generator;
-    Node* selection(Node* node);
-    void backpropagation(Node* node, Node* endNode, bool isXTurn, double win);
-    int playout(Node* node);
-    double parallelPlayouts(int thread, int simulationTimes, Node* node);
+    uint64_t seed;                             ///< 所有 playout 亂數流的種子
+    std::atomic<uint64_t> nextIteration{0};  ///< 下一個 iteration 的編號
+    std::atomic<bool> stopRequested{false};  ///< 要求所有搜尋迴圈在目前的 iteration 後結束
+    using Clock = std::chrono::steady_clock;
+    static constexpr int CLOCK_CHECK_PLAYOUTS = 64;  ///< 大約每跑這麼多次 playout 看一次時鐘
+    static constexpr int MIN_EARLY_STOP_VISITS = 64;  ///< 估計搜尋速度前至少要完成的 iteration 數
+    Clock::time_point searchStart;
+    Clock::time_point deadline = Clock::time_point::max();  ///< 沒有時間限制時為 max()
+    int searchStartVisits = 0;                                ///< 本次搜尋開始時根節點的訪問次數
+    int clockCheckInterval = 1;                               ///< 每個執行緒每幾個 iteration 看一次時鐘
+    std::atomic<bool> deadlineReached{false};                 ///< 時間用完或已可提早結束
+#ifdef GOMOKU_INSTRUMENT
+    instrument::SearchWindow lastSearch;  ///< 最近一次搜尋的量測區間
+#endif
+    std::thread ponderThread;
+    /// 每個執行緒各自配置節點的 arena，arenas[0] 同時是主執行緒的 arena；
+    /// 多配置一個給根平行搜尋：第 workerId 個執行緒的暫存樹放在 arenas[workerId + 1]
+    std::vector<NodeArena<N>> arenas;
+    NodeArena<N> spareArena;           ///< 推進根節點時用來壓縮保留子樹的備用 arena
+    static constexpr size_t DEFAULT_TRANSPOSITION_ENTRIES = 1 << 18;
+    static constexpr size_t MIN_NODE_BUDGET = 4 * Board<N>::CELLS;  ///< 保證壓縮後一定放得下根節點的子節點區塊
+    size_t nodeBudget = 0;                                          ///< 節點數上限，0 表示不限制
+    std::atomic<size_t> allocatedNodes{0};                          ///< 目前所有 arena 中的節點數
+    std::atomic<bool> memoryFull{false};                            ///< 有拓展因為節點數上限被放棄
+    bool pruneWhenFull = false;                                     ///< 本次搜尋是否在節點用完時暫停並壓縮樹
+    /// 根節點固定放在 arena 之外，搜尋中途壓縮樹時呼叫端拿到的根節點指標依然有效
+    Node<N> rootNode;
+    static constexpr int MAX_PATH = Board<N>::CELLS + 1;  ///< 選擇路徑的最大長度（根節點 + 每一步）
+    TranspositionTable<N> transpositions;  ///< 根平行模式下各執行緒的樹彼此獨立，不使用置換表
+    const TreeSnapshot<N>* snapshot = nullptr;
+    /// @brief 把 source 的子樹複製到 spareArena 底下的 target，訪問次數少於 minVisits 的節點不帶子樹
+    void copyChildren(const Node<N>* source, Node<N>* target, int minVisits);
+    /**
+     * @brief 以 source 的子樹取代整棵搜尋樹（根節點為 rootNode），其餘節點隨舊 arena 一次回收
+     *
+     * 有節點上限時只保留訪問次數最多、合計不超過上限一半的子節點區塊。
+     */
+    void compact(const Node<N>* source);
+    /// @brief 保留區塊的父節點訪問次數門檻，使保留的節點數不超過 target
+    int pruneThreshold(const Node<N>* root, size_t target) const;
+    /// @brief 重新計算 allocatedNodes（沒有搜尋進行中時呼叫）
+    void recountNodes();
+    Node<N>* expansion(Node<N>* node, NodeArena<N>& arena);
+    /// @brief 根節點還沒有任何訪問時帶入快照中同一局面的統計
+    void seedRoot(Node<N>* root);
+    /// @brief 把快照中同一局面 saved 的子節點統計帶入剛建立、尚未發佈的子節點區塊
+    void seedFromSnapshot(const typename TreeSnapshot<N>::SnapshotNode* saved, Node<N>* block, int count);
+    /// @brief 父節點訪問 visits 次時最多打開的子節點數
+    int openWidth(int visits) const;
+    /**
+     * @brief 依序打開 node 的候選格直到至少 target 個子節點（不可超過 candidateCount）
+     *
+     * @return int 打開後的 childCount
+     */
+    int widen(Node<N>* node, int target);
+    /**
+     * @brief 依先驗分數由高到低排列候選著手（格子索引），分數相同時索引小的在前
+     *
+     * @return int 候選著手數
+     */
+    static int rankCandidates(const Node<N>* node, const uint64_t* candidates, int* moves);
+    void treeParallelSearch(Node<N>* root, int iterations);
+    void rootParallelSearch(Node<N>* root, int iterations);
+    void runWorkers(const std::function<void(int)>& worker);
+    void searchIteration(Node<N>* root, NodeArena<N>& arena, uint64_t iteration);
+    bool keepSearching(Node<N>* root, int completed);
+    bool leaderDecided(Node<N>* root, Clock::time_point now);
+    int selection(Node<N>* node, Node<N>** path);
+    void backpropagation(Node<N>** path, int length, bool isXTurn, double win);
+    /**
+     * @brief 依子節點的證明狀態嘗試證明 node
+     *
+     * @return true 如果 node 已被證明（包含先前就已證明）
+     */
+    bool updateProof(Node<N>* node);
+    /// @brief 把證明由 path 的葉節點往根傳遞，遇到仍無法證明的節點就停止
+    void propagateProof(Node<N>** path, int length);
+    /// @brief 拓展後的第一個葉節點：有直接必勝的子節點時 node 即證明必敗，回傳該子節點
+    Node<N>* firstLeaf(Node<N>* node);
+    /**
+     * @brief 從 node 跑第 firstSlot ~ firstSlot + count - 1 號 playout，回傳結果總和
+     *
+     * 隨機 playout 在有批次 kernel 時每 PLAYOUT_BATCH 局一起跑，其餘逐局呼叫 playout。
+     */
+    int runPlayouts(Node<N>* node, uint64_t iteration, int firstSlot, int count);
+    int playout(Node<N>* node, PlayoutRng& rng);
+    int randomPlayout(Node<N>* node, PlayoutRng& rng);
+    int patternPlayout(Node<N>* node, PlayoutRng& rng);
+    /// @brief 交給執行緒池的固定簽名 playout 工作
+    struct PlayoutJob {
+        MCTS* mcts;
+        Node<N>* node;
+        uint64_t iteration;
+        int firstSlot;  ///< 此工作第一個 playout 在 iteration 內的編號
+        int runTimes;
+        int result;
+        std::atomic<int>* remaining;
+    };
+    static void runPlayoutJob(void* argument);
+    double parallelPlayouts(int thread, int simulationTimes, Node<N>* node, uint64_t iteration);
 };
 
+extern template class MCTS<9>;
+extern template class MCTS<15>;
+extern template class MCTS<19>;
+
 #endif
\ No newline at end of file
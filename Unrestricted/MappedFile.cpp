@@ -0,0 +1,82 @@
+#include "MappedFile.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+bool MappedFile::open(const char* path) {
+    close();
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                              nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+    // 映射建立後就不再需要檔案 handle
+    HANDLE handle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (handle == nullptr) {
+        return false;
+    }
+    void* view = MapViewOfFile(handle, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr) {
+        CloseHandle(handle);
+        return false;
+    }
+    mapping = handle;
+    bytes = static_cast<const unsigned char*>(view);
+    length = static_cast<size_t>(fileSize.QuadPart);
+    return true;
+}
+
+void MappedFile::close() {
+    if (bytes != nullptr) {
+        UnmapViewOfFile(bytes);
+        CloseHandle(mapping);
+    }
+    bytes = nullptr;
+    mapping = nullptr;
+    length = 0;
+}
+#else
+bool MappedFile::open(const char* path) {
+    close();
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat status;
+    if (fstat(fd, &status) != 0 || status.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+    // 映射建立後就不再需要檔案描述子
+    void* view = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        return false;
+    }
+    bytes = static_cast<const unsigned char*>(view);
+    length = static_cast<size_t>(status.st_size);
+    return true;
+}
+
+void MappedFile::close() {
+    if (bytes != nullptr) {
+        munmap(const_cast<unsigned char*>(bytes), length);
+    }
+    bytes = nullptr;
+    length = 0;
+}
+#endif
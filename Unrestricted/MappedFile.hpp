@@ -0,0 +1,37 @@
+#ifndef MAPPEDFILE_HPP
+#define MAPPEDFILE_HPP
+
+#include <cstddef>
+
+/**
+ * @brief 唯讀的記憶體映射檔案
+ *
+ * 開檔時只建立映射、不讀取內容，實際用到的頁面才由作業系統載入，所以再大的檔案開啟也只要幾微秒，
+ * 多個行程映射同一個檔案時共用同一份 page cache。POSIX 使用 mmap，Windows 使用 MapViewOfFile。
+ */
+class MappedFile {
+   public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief 映射 path 的整個檔案，失敗（檔案不存在、空檔案）時回傳 false
+     */
+    bool open(const char* path);
+    void close();
+
+    bool isOpen() const { return bytes != nullptr; }
+    const unsigned char* data() const { return bytes; }
+    size_t size() const { return length; }
+
+   private:
+    const unsigned char* bytes = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    void* mapping = nullptr;  ///< CreateFileMapping 的 handle
+#endif
+};
+
+#endif  // MAPPEDFILE_HPP
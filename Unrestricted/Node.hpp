@@ -3,59 +3,65 @@
 
 #include <stdint.h>
 
-#include <array>
-#include <vector>
+#include <atomic>
+#include <cstring>
 
+#include "Bitboard.hpp"
 #include "Game.hpp"
-using std::array;
-#define BITBOARD_COUNT ((BOARD_SIZE * BOARD_SIZE + 63) / 64)  // 計算需要多少個 uint64_t 來表示整個棋盤
-constexpr int MAX_CHILDREN = 225;                             ///< 每個節點最多的子節點數量（對應 15x15 棋盤）
-
-struct Position {
-    int x;
-    int y;
-};
-// 使用 constexpr 确保编译期计算
-constexpr std::array<Position, MAX_CHILDREN> createLookupTable() {
-    std::array<Position, MAX_CHILDREN> table{};
-    for (int index = 0; index < MAX_CHILDREN; ++index) {
-        table[index].x = index / BOARD_SIZE;
-        table[index].y = index % BOARD_SIZE;
-    }
-    return table;
-}
-
-// 全局常量查找表
-constexpr std::array<Position, MAX_CHILDREN> globalLookupTable = createLookupTable();
-
-inline void setBit(uint64_t* bitboard, Position lastMove) {
-    int pos = lastMove.x * BOARD_SIZE + lastMove.y;
-    bitboard[pos >> 6] |= 1ULL << (pos & 63);
-}
-inline void setBit(uint64_t* bitboard, int pos) { bitboard[pos >> 6] |= 1ULL << (pos & 63); }
-inline bool getBit(uint64_t* bitboard, Position position) {
-    int pos = position.x * BOARD_SIZE + position.y;
-    return bitboard[pos >> 6] & (1ULL << (pos & 63));
-}
-inline bool getBit(uint64_t* bitboard, int pos) { return bitboard[pos >> 6] & (1ULL << (pos & 63)); }
+#include "Zobrist.hpp"
 /**
  * @brief 表示遊戲節點的結構體，用於蒙特卡洛樹搜索 (MCTS)
  *
  * 這個結構體代表遊戲樹中的每個節點，包含棋盤狀態、勝利次數、訪問次數等資訊。
  * 每個節點可以有多個子節點，並且每個節點有對應的父節點，這些節點構成了整個蒙特卡洛樹。
  * 節點使用位棋盤 (bitboard) 來表示當前的棋盤狀態，其中：
- * - `boardX` 記錄 X 玩家的落子位置
- * - `boardO` 記錄 O 玩家的落子位置
- * - `isXTurn` 記錄當前是否輪到 X 玩家
+ * - `boardBlack` 記錄黑棋的落子位置
+ * - `boardWhite` 記錄白棋的落子位置
+ * - `isBlackTurn` 記錄這個節點的最後一步是否由黑棋落下
+ *
+ * 子節點不再使用固定 225 格的指標陣列，而是由 `expansion` 從 `NodeArena` 一次配置的連續區塊，
+ * `children` 指向區塊開頭、`candidateCount` 記錄區塊長度（所有候選著手）。位棋盤的長度由棋盤大小 N 決定，
+ * 15x15 時整個節點控制在兩條 cache line 內（19x19 為三條）。
+ *
+ * 區塊依先驗分數排列，只有前 `childCount` 個是建立好的子節點，其餘是只記錄著手的候選格
+ * (CHILD_PENDING)，要等漸進拓寬打開時才以 `materialize` 複製棋盤、計算雜湊與判斷連五。
+ * 候選格一律依序打開，所以已建立的子節點永遠是區塊的前綴，區塊本身不會搬動。
+ *
+ * 統計資料皆為 atomic，讓樹平行搜尋的多個執行緒可以同時更新同一棵樹：
+ * 拓展時先以 `expanding` 取得拓展權，寫好 `children` 後再以 release 發佈 `childCount`，
+ * 因此讀到非 0 的 `childCount` 就保證 `children` 的前 `childCount` 個節點已經可用。
+ *
+ * 啟用置換表時，相同局面的節點會共用同一個子節點區塊，`parent` 只記錄建立該區塊的那個父節點，
+ * 回傳結果時要沿著選擇時記錄的路徑，而不是沿著 `parent`。
+ *
+ * `proven` 是 MCTS-Solver 的證明狀態，與 `wins` 相同以落下 `lastMove` 的一方為準：
+ * 連五的節點一開始就是 PROVEN_WIN；某個子節點必勝，代表輪到的一方有必勝著，本節點即為 PROVEN_LOSS；
+ * 所有子節點都必敗時本節點為 PROVEN_WIN。狀態一旦決定就不再改變。
  */
-struct Node {
+enum proofStatus : int8_t { PROVEN_LOSS = -1, UNPROVEN = 0, PROVEN_WIN = 1 };
+/**
+ * @brief 節點在子節點區塊中的建立狀態：同一個區塊可能由置換表共用，打開候選格時以此確保只建立一次
+ */
+enum childState : uint8_t { CHILD_PENDING = 0, CHILD_BUILDING = 1, CHILD_READY = 2 };
+
+template <int N>
+struct alignas(64) Node {
+    static constexpr int BITBOARD_COUNT = Board<N>::BITBOARD_COUNT;
+
     uint64_t boardBlack[BITBOARD_COUNT];  ///< 位棋盤 (bitboard) 表示棋盤狀態
     uint64_t boardWhite[BITBOARD_COUNT];  ///< 位棋盤 (bitboard) 表示棋盤狀態
+    uint64_t hash;                        ///< 局面的 Zobrist 雜湊
     Node* parent;                         ///< 指向父節點的指標
-    Node* children[MAX_CHILDREN];         ///< 指向子節點的指標陣列
-    Position lastMove;                    ///< 最後一步的位置 (假設 Position 是較小的結構)
-    double wins;                          ///< 該節點的獲勝次數
-    int visits;                           ///< 該節點的訪問次數
+    Node* children;                       ///< 指向連續子節點區塊的開頭，尚未拓展時為 nullptr
+    std::atomic<double> wins;             ///< 該節點的獲勝次數
+    std::atomic<int> visits;              ///< 該節點的訪問次數
+    std::atomic<int> virtualLoss;         ///< 樹平行搜尋中正經過此節點、尚未回傳結果的次數
+    Position lastMove;                    ///< 最後一步的位置
+    std::atomic<uint16_t> childCount;     ///< 子節點區塊中已建立（已打開）的節點數量
+    uint16_t candidateCount;              ///< 子節點區塊的長度，發佈 childCount 前寫好
+    std::atomic<bool> expanding;          ///< 是否已有執行緒取得拓展權
+    std::atomic<int8_t> proven;           ///< 證明狀態 (proofStatus)
+    std::atomic<uint8_t> state;           ///< 在子節點區塊中的建立狀態 (childState)
     bool isWin;                           ///< 是否是終局節點
     bool isBlackTurn;
 
@@ -68,16 +74,28 @@ struct Node {
      * - 棋盤狀態 (`board`) 設為 0（表示棋盤為空）
      * - `isBlackTurn` 設為 `false`（假設 Black 先手）
      * - 父節點 (`parent`) 設為 `nullptr`
-     * - 所有子節點 (`children`) 初始化為空指標
+     * - 子節點區塊 (`children`) 設為空
      */
-    Node() : wins(0), visits(0), parent(nullptr), isBlackTurn(false), lastMove({-1, -1}), isWin(false) {
+    Node()
+        : hash(0),
+          parent(nullptr),
+          children(nullptr),
+          wins(0),
+          visits(0),
+          virtualLoss(0),
+          lastMove({-1, -1}),
+          childCount(0),
+          candidateCount(0),
+          expanding(false),
+          proven(UNPROVEN),
+          state(CHILD_READY),
+          isWin(false),
+          isBlackTurn(false) {
         // 初始化棋盤為全 0 (空棋盤)
         memset(boardBlack, 0, sizeof(boardBlack));
         memset(boardWhite, 0, sizeof(boardWhite));
-        boardBlack[3] = 0xFFFFFFFE00000000;  // 沒用到的bit直接賦值為1=佔據
-        boardWhite[3] = 0xFFFFFFFE00000000;  // 沒用到的bit直接賦值為1=佔據
-        // 初始化所有子節點為 nullptr
-        memset(children, 0, sizeof(children));
+        boardBlack[BITBOARD_COUNT - 1] = Board<N>::PADDING_MASK;  // 沒用到的bit直接賦值為1=佔據
+        boardWhite[BITBOARD_COUNT - 1] = Board<N>::PADDING_MASK;  // 沒用到的bit直接賦值為1=佔據
     }
 
     /**
@@ -89,45 +107,103 @@ struct Node {
      * - `isBlackTurn` 會與父節點相反，表示輪流落子
      * - 根據 `isBlackTurn`，將 `move` 位置標記到對應的棋盤
      *
-     * @param move 該節點對應的棋盤移動位置 (0~8)，表示當前玩家落子的格子
+     * @param move 該節點對應的棋盤移動位置，表示當前玩家落子的格子
      * @param parent 指向父節點的指標，表示該子節點由哪個父節點衍生
      */
-    Node(Position lastMove, Node* parent)
-        : wins(0), visits(0), parent(parent), isBlackTurn(!parent->isBlackTurn), lastMove(lastMove) {
+    Node(Position lastMove, Node* parent) : Node(lastMove) {
+        materialize(parent);
+        state.store(CHILD_READY, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 建立尚未打開的候選格 (CHILD_PENDING)：只記錄著手，棋盤與雜湊留給 materialize
+     */
+    explicit Node(Position lastMove)
+        : hash(0),
+          parent(nullptr),
+          children(nullptr),
+          wins(0),
+          visits(0),
+          virtualLoss(0),
+          lastMove(lastMove),
+          childCount(0),
+          candidateCount(0),
+          expanding(false),
+          proven(UNPROVEN),
+          state(CHILD_PENDING),
+          isWin(false),
+          isBlackTurn(false) {}
+
+    /**
+     * @brief 子節點區塊中已建立的節點數，沒有搜尋進行中時呼叫
+     *
+     * 置換表共用同一個區塊時，各父節點的 childCount 只記錄自己打開過的數量，
+     * 區塊中實際已建立的節點可能比它多；複製或存檔整個區塊時要以這個數量為準。
+     */
+    int builtChildren() const {
+        int count = childCount.load(std::memory_order_acquire);
+        if (count == 0) {
+            return 0;  // 還沒拓展（或已被回收）
+        }
+        while (count < candidateCount && children[count].state.load(std::memory_order_acquire) == CHILD_READY) {
+            count++;
+        }
+        return count;
+    }
+
+    /**
+     * @brief 以父節點的局面建立候選格的棋盤、雜湊與連五判斷（不改變 state，由呼叫端發佈）
+     */
+    void materialize(Node* parent) {
+        this->parent = parent;
+        isBlackTurn = !parent->isBlackTurn;
+        hash = parent->hash ^ zobristKey<N>(Board<N>::index(lastMove), isBlackTurn);
         // 繼承父節點的棋盤狀態
         memcpy(boardBlack, parent->boardBlack, sizeof(uint64_t) * BITBOARD_COUNT);
         memcpy(boardWhite, parent->boardWhite, sizeof(uint64_t) * BITBOARD_COUNT);
         // 根據當前玩家，將落子位置標記到對應的棋盤
         if (isBlackTurn) {
-            setBit(boardBlack, lastMove);
+            Board<N>::setBit(boardBlack, lastMove);
         } else {
-            setBit(boardWhite, lastMove);
+            Board<N>::setBit(boardWhite, lastMove);
         }
-        if (Game::checkWin(lastMove, boardBlack, boardWhite, isBlackTurn)) {
-            isWin = true;
-        } else {
-            isWin = false;
+        isWin = Game<N>::checkWin(lastMove, boardBlack, boardWhite, isBlackTurn);
+        if (isWin) {
+            proven.store(PROVEN_WIN, std::memory_order_relaxed);
         }
-        // 初始化所有子節點為 nullptr
-        memset(children, 0, sizeof(children));
+    }
+
+    /**
+     * @brief 複製節點（用於壓縮搜尋樹），複製時不應有其他執行緒在更新此節點
+     */
+    Node(const Node& other)
+        : hash(other.hash),
+          parent(other.parent),
+          children(other.children),
+          wins(other.wins.load(std::memory_order_relaxed)),
+          visits(other.visits.load(std::memory_order_relaxed)),
+          virtualLoss(0),
+          lastMove(other.lastMove),
+          childCount(other.childCount.load(std::memory_order_relaxed)),
+          candidateCount(other.candidateCount),
+          expanding(other.expanding.load(std::memory_order_relaxed)),
+          proven(other.proven.load(std::memory_order_relaxed)),
+          state(other.state.load(std::memory_order_relaxed)),
+          isWin(other.isWin),
+          isBlackTurn(other.isBlackTurn) {
+        memcpy(boardBlack, other.boardBlack, sizeof(boardBlack));
+        memcpy(boardWhite, other.boardWhite, sizeof(boardWhite));
     }
 };
+static_assert(sizeof(Node<15>) <= 128, "15x15 的 Node 應保持在兩條 cache line 之內");
 
 /**
- * @brief 刪除整棵樹，釋放所有節點的記憶體
- *
- * @param node 根節點
+ * @brief 以 CAS 迴圈對 atomic<double> 做加法（不依賴 C++20 的浮點 fetch_add）
  */
-inline void deleteTree(Node* node) {
-    if (node == nullptr) return;
-
-    for (int i = 0; i < MAX_CHILDREN; i++) {
-        if (node->children[i] != nullptr) {
-            deleteTree(node->children[i]);
-            node->children[i] = nullptr;  // 防止重複刪除
-        }
+inline void atomicAdd(std::atomic<double>& target, double value) {
+    double current = target.load(std::memory_order_relaxed);
+    while (!target.compare_exchange_weak(current, current + value, std::memory_order_relaxed)) {
     }
-
-    delete node;
 }
+
 #endif  // NODE_HPP
@@ -0,0 +1,99 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Node.hpp"
+
+/**
+ * @brief 搜尋樹專用的節點配置器 (bump allocator)
+ *
+ * 記憶體以固定大小的 chunk 向系統要一次，之後 `allocate` 只需要移動游標，
+ * 子節點區塊一定落在同一個 chunk 內而保持連續。節點不會個別釋放，
+ * 整個 arena 由 `reset` 一次回收（保留 chunk 供下一輪重用），因此沒有任何逐節點的 delete。
+ */
+template <int N>
+class NodeArena {
+   public:
+    static constexpr size_t DEFAULT_CHUNK_CAPACITY = 1 << 14;  ///< 每個 chunk 可容納的節點數（約 2MB）
+
+   private:
+    static_assert(std::is_trivially_destructible_v<Node<N>>, "NodeArena 不會呼叫節點的解構函式");
+
+    std::vector<Node<N>*> chunks;
+    size_t chunkCapacity;
+    size_t currentChunk;  ///< 目前配置中的 chunk 索引
+    size_t used;          ///< 目前 chunk 已使用的節點數
+    size_t retired;       ///< 先前 chunk 已使用的節點數總和
+
+    static Node<N>* newChunk(size_t capacity) {
+        return static_cast<Node<N>*>(::operator new(sizeof(Node<N>) * capacity, std::align_val_t{alignof(Node<N>)}));
+    }
+
+   public:
+    explicit NodeArena(size_t chunkCapacity = DEFAULT_CHUNK_CAPACITY);
+    ~NodeArena();
+    NodeArena(const NodeArena&) = delete;
+    NodeArena& operator=(const NodeArena&) = delete;
+
+    /**
+     * @brief 配置 count 個連續節點的空間（尚未建構，需以 placement new 建構）
+     */
+    Node<N>* allocate(int count) {
+        if (used + count > chunkCapacity) {
+            retired += used;
+            used = 0;
+            if (++currentChunk == chunks.size()) {
+                chunks.push_back(newChunk(chunkCapacity));
+            }
+        }
+        Node<N>* block = chunks[currentChunk] + used;
+        used += count;
+        return block;
+    }
+
+    /**
+     * @brief 一次回收所有節點，chunk 保留給之後的配置使用
+     */
+    void reset() {
+        currentChunk = 0;
+        used = 0;
+        retired = 0;
+    }
+
+    /**
+     * @brief 把目前 chunk 之後沒有用到的 chunk 還給系統（reset 後呼叫即只保留一個 chunk）
+     */
+    void shrink() {
+        for (size_t i = currentChunk + 1; i < chunks.size(); i++) {
+            ::operator delete(chunks[i], std::align_val_t{alignof(Node<N>)});
+        }
+        chunks.resize(currentChunk + 1);
+    }
+
+    void swap(NodeArena& other) noexcept {
+        chunks.swap(other.chunks);
+        std::swap(chunkCapacity, other.chunkCapacity);
+        std::swap(currentChunk, other.currentChunk);
+        std::swap(used, other.used);
+        std::swap(retired, other.retired);
+    }
+
+    /// @brief 目前已配置的節點數
+    size_t size() const { return retired + used; }
+    /// @brief 向系統要的記憶體（含 chunk 中尚未配置的部分）
+    size_t reservedBytes() const { return chunks.size() * chunkCapacity * sizeof(Node<N>); }
+};
+
+template <int N>
+NodeArena<N>::NodeArena(size_t chunkCapacity)
+    : chunks{newChunk(chunkCapacity)}, chunkCapacity(chunkCapacity), currentChunk(0), used(0), retired(0) {}
+
+template <int N>
+NodeArena<N>::~NodeArena() {
+    for (Node<N>* chunk : chunks) {
+        ::operator delete(chunk, std::align_val_t{alignof(Node<N>)});
+    }
+}
@@ -0,0 +1,110 @@
+#include "OpeningBook.hpp"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <utility>
+
+#include "Zobrist.hpp"
+
+template <int N>
+bool OpeningBook<N>::open(const char* path) {
+    entries = nullptr;
+    count = 0;
+    if (!file.open(path)) {
+        return false;
+    }
+    // 只檢查檔頭與檔案長度，不讀取任何條目
+    const BookHeader* header = reinterpret_cast<const BookHeader*>(file.data());
+    if (file.size() < sizeof(BookHeader) || header->magic != MAGIC || header->version != VERSION ||
+        header->boardSize != N || file.size() != sizeof(BookHeader) + header->entryCount * sizeof(BookEntry)) {
+        file.close();
+        return false;
+    }
+    entries = reinterpret_cast<const BookEntry*>(file.data() + sizeof(BookHeader));
+    count = header->entryCount;
+    return true;
+}
+
+template <int N>
+Position OpeningBook<N>::probe(const Node<N>* node) const {
+    if (!isOpen()) {
+        return {-1, -1};
+    }
+    int symmetry;
+    uint64_t key = canonicalKey(node->boardBlack, node->boardWhite, &symmetry);
+    const BookEntry* entry =
+        std::lower_bound(entries, entries + count, key, [](const BookEntry& e, uint64_t k) { return e.key < k; });
+    if (entry == entries + count || entry->key != key || entry->move >= Board<N>::CELLS) {
+        return {-1, -1};
+    }
+    int move = untransform(entry->move, symmetry);
+    // 雜湊碰撞時著手可能落在已有棋子的格子，當作沒有收錄
+    if (getBit(node->boardBlack, move) || getBit(node->boardWhite, move)) {
+        return {-1, -1};
+    }
+    return Board<N>::LOOKUP_TABLE[move];
+}
+
+template <int N>
+int OpeningBook<N>::transform(int pos, int symmetry) {
+    int x = pos / N, y = pos % N;
+    if (symmetry & 1) x = N - 1 - x;
+    if (symmetry & 2) y = N - 1 - y;
+    if (symmetry & 4) std::swap(x, y);
+    return x * N + y;
+}
+
+template <int N>
+int OpeningBook<N>::untransform(int pos, int symmetry) {
+    int x = pos / N, y = pos % N;
+    if (symmetry & 4) std::swap(x, y);
+    if (symmetry & 1) x = N - 1 - x;
+    if (symmetry & 2) y = N - 1 - y;
+    return x * N + y;
+}
+
+template <int N>
+uint64_t OpeningBook<N>::canonicalKey(const uint64_t* boardBlack, const uint64_t* boardWhite, int* symmetry) {
+    uint64_t keys[SYMMETRY_COUNT] = {};
+    for (int side = 0; side < 2; side++) {
+        const uint64_t* board = side == 0 ? boardBlack : boardWhite;
+        uint64_t stones[Board<N>::BITBOARD_COUNT];
+        for (int i = 0; i < Board<N>::BITBOARD_COUNT; i++) {
+            stones[i] = board[i] & Board<N>::VALID_MASK[i];
+        }
+        Board<N>::forEachBit(stones, [&](int pos) {
+            for (int s = 0; s < SYMMETRY_COUNT; s++) {
+                keys[s] ^= zobristKey<N>(transform(pos, s), side == 0);
+            }
+        });
+    }
+    *symmetry = 0;
+    for (int s = 1; s < SYMMETRY_COUNT; s++) {
+        if (keys[s] < keys[*symmetry]) *symmetry = s;
+    }
+    return keys[*symmetry];
+}
+
+template <int N>
+bool OpeningBook<N>::write(const char* path, std::vector<BookEntry> entries) {
+    std::sort(entries.begin(), entries.end(), [](const BookEntry& a, const BookEntry& b) {
+        return a.key != b.key ? a.key < b.key : a.visits > b.visits;
+    });
+    entries.erase(std::unique(entries.begin(), entries.end(),
+                              [](const BookEntry& a, const BookEntry& b) { return a.key == b.key; }),
+                  entries.end());
+    FILE* out = fopen(path, "wb");
+    if (out == nullptr) {
+        return false;
+    }
+    BookHeader header = {MAGIC, VERSION, static_cast<uint32_t>(N), entries.size()};
+    bool ok = fwrite(&header, sizeof(header), 1, out) == 1 &&
+              fwrite(entries.data(), sizeof(BookEntry), entries.size(), out) == entries.size();
+    return fclose(out) == 0 && ok;
+}
+
+template class OpeningBook<9>;
+template class OpeningBook<15>;
+template class OpeningBook<19>;
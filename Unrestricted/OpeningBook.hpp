@@ -0,0 +1,88 @@
+#ifndef OPENINGBOOK_HPP
+#define OPENINGBOOK_HPP
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "Bitboard.hpp"
+#include "MappedFile.hpp"
+#include "Node.hpp"
+
+constexpr const char* DEFAULT_BOOK_PATH = "opening.book";  ///< 對局程式啟動時嘗試載入的開局庫
+
+/**
+ * @brief 以記憶體映射讀取的二進位開局庫
+ *
+ * 檔案格式（本機位元組序）：24 byte 的 BookHeader，之後是依 key 由小到大排序的 BookEntry 陣列。
+ * 開啟時只檢查檔頭，查詢是在映射的陣列上做二分搜尋，只會碰到 log2(n) 個頁面，
+ * 所以幾百 MB 的開局庫也能瞬間載入、每次查詢只要幾微秒。
+ *
+ * 局面以標準形 (canonical form) 的 Zobrist 雜湊為 key：棋盤的八種對稱（旋轉、翻轉）各算一次雜湊取最小值，
+ * 著手也以該對稱轉換後的座標保存，因此對稱的局面只需要存一次。
+ *
+ * 樣板只在 OpeningBook.cpp 中對支援的棋盤大小（9、15、19）明確實例化。
+ */
+template <int N>
+class OpeningBook {
+   public:
+    static constexpr uint64_t MAGIC = 0x314B4F4F424B4D47ULL;  ///< "GMKBOOK1"
+    static constexpr uint32_t VERSION = 1;
+    static constexpr int SYMMETRY_COUNT = 8;
+
+    struct BookHeader {
+        uint64_t magic;
+        uint32_t version;
+        uint32_t boardSize;
+        uint64_t entryCount;
+    };
+
+    struct BookEntry {
+        uint64_t key;     ///< 標準形的 Zobrist 雜湊
+        uint32_t visits;  ///< 建庫時最佳著手的訪問次數
+        uint16_t move;    ///< 標準形座標下的最佳著手
+        int16_t winRate;  ///< 建庫時最佳著手的勝率（萬分比，以落子方為準）
+    };
+    static_assert(sizeof(BookHeader) == 24 && sizeof(BookEntry) == 16, "檔案格式不能有額外的 padding");
+
+    /**
+     * @brief 映射開局庫檔案，檔案不存在、棋盤大小不符或格式錯誤時回傳 false
+     */
+    bool open(const char* path);
+    bool isOpen() const { return entries != nullptr; }
+    size_t size() const { return count; }
+
+    /**
+     * @brief 查詢輪到的一方在 node 局面的開局著手
+     *
+     * @return Position 開局庫中的著手；沒有收錄此局面時為 {-1, -1}
+     */
+    Position probe(const Node<N>* node) const;
+
+    /**
+     * @brief 計算局面的標準形雜湊
+     *
+     * @param symmetry 寫入取得最小雜湊的對稱編號，用 transform 把著手轉到標準形座標
+     */
+    static uint64_t canonicalKey(const uint64_t* boardBlack, const uint64_t* boardWhite, int* symmetry);
+    /// @brief 以第 symmetry 種對稱轉換格子索引
+    static int transform(int pos, int symmetry);
+    /// @brief transform 的反轉換
+    static int untransform(int pos, int symmetry);
+
+    /**
+     * @brief 把 entries 排序後寫成開局庫檔案，相同 key 只保留訪問次數最多的一筆
+     */
+    static bool write(const char* path, std::vector<BookEntry> entries);
+
+   private:
+    MappedFile file;
+    const BookEntry* entries = nullptr;
+    size_t count = 0;
+};
+
+extern template class OpeningBook<9>;
+extern template class OpeningBook<15>;
+extern template class OpeningBook<19>;
+
+#endif  // OPENINGBOOK_HPP
@@ -0,0 +1,71 @@
+#include "Pattern.hpp"
+
+#include <stdint.h>
+
+#include <array>
+
+namespace {
+constexpr int WINDOW_SIZE = 9;
+constexpr uint32_t CENTER = 1u << 4;
+constexpr uint32_t WINDOW_MASK = (1u << WINDOW_SIZE) - 1;
+constexpr uint8_t UNKNOWN = 0xFF;
+
+bool hasFive(uint32_t own) { return own & (own >> 1) & (own >> 2) & (own >> 3) & (own >> 4); }
+
+/**
+ * @brief 計算中心格已落子的 9 格視窗的棋型，以 (own, blocked) 為鍵做 memoization
+ *
+ * 定義是遞迴的：能一步連五的空位有兩個以上是活四、一個是衝四；
+ * 否則看再下一步最好能變成什麼，活四之前一步是活三、衝四之前一步是眠三，依此類推。
+ */
+uint8_t classify(uint32_t own, uint32_t blocked, std::array<uint8_t, 1 << (2 * WINDOW_SIZE)>& memo) {
+    uint8_t& cached = memo[own | (blocked << WINDOW_SIZE)];
+    if (cached != UNKNOWN) return cached;
+    if (hasFive(own)) return cached = PATTERN_FIVE;
+
+    uint32_t empty = ~(own | blocked) & WINDOW_MASK;
+    int fiveCompletions = 0;
+    for (uint32_t bits = empty; bits; bits &= bits - 1) {
+        if (hasFive(own | (bits & -bits))) fiveCompletions++;
+    }
+    if (fiveCompletions >= 2) return cached = PATTERN_OPEN_FOUR;
+    if (fiveCompletions == 1) return cached = PATTERN_FOUR;
+
+    uint8_t best = PATTERN_NONE;
+    for (uint32_t bits = empty; bits; bits &= bits - 1) {
+        uint8_t next = classify(own | (bits & -bits), blocked, memo);
+        if (next > best) best = next;
+    }
+    // 再一步能到達的棋型往下降一級（活四 -> 活三、衝四 -> 眠三、活三 -> 活二、眠三 -> 眠二）
+    switch (best) {
+        case PATTERN_OPEN_FOUR:
+            return cached = PATTERN_OPEN_THREE;
+        case PATTERN_FOUR:
+            return cached = PATTERN_THREE;
+        case PATTERN_OPEN_THREE:
+            return cached = PATTERN_OPEN_TWO;
+        case PATTERN_THREE:
+            return cached = PATTERN_TWO;
+        default:
+            return cached = PATTERN_NONE;
+    }
+}
+
+/// @brief 把 8 bit 的索引還原成 9 bit 視窗（中心格為 0）
+uint32_t expandWindow(uint32_t compressed) { return (compressed & 0xF) | ((compressed >> 4) << 5); }
+
+std::array<uint8_t, PATTERN_TABLE_SIZE> buildPatternTable() {
+    std::array<uint8_t, PATTERN_TABLE_SIZE> table{};
+    auto* memo = new std::array<uint8_t, 1 << (2 * WINDOW_SIZE)>;
+    memo->fill(UNKNOWN);
+    for (uint32_t index = 0; index < PATTERN_TABLE_SIZE; index++) {
+        uint32_t own = expandWindow(index & 0xFF);
+        uint32_t blocked = expandWindow(index >> 8);
+        table[index] = (own & blocked) ? static_cast<uint8_t>(PATTERN_NONE) : classify(own | CENTER, blocked, *memo);
+    }
+    delete memo;
+    return table;
+}
+}  // namespace
+
+const std::array<uint8_t, PATTERN_TABLE_SIZE> patternTable = buildPatternTable();
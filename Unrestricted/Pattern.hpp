@@ -0,0 +1,51 @@
+#ifndef PATTERN_HPP
+#define PATTERN_HPP
+
+#include <stdint.h>
+
+#include <array>
+
+#include "LineBoard.hpp"
+
+/**
+ * @brief 在某格落子後，該格在單一方向上形成的棋型（數值越大越強）
+ */
+enum PatternType : uint8_t {
+    PATTERN_NONE = 0,
+    PATTERN_TWO = 1,         ///< 再下一步可成為眠三
+    PATTERN_OPEN_TWO = 2,    ///< 再下一步可成為活三
+    PATTERN_THREE = 3,       ///< 眠三：再下一步可成為衝四
+    PATTERN_OPEN_THREE = 4,  ///< 活三：再下一步可成為活四
+    PATTERN_FOUR = 5,        ///< 衝四：只剩一個點可以連五
+    PATTERN_OPEN_FOUR = 6,   ///< 活四：有兩個以上的點可以連五
+    PATTERN_FIVE = 7,        ///< 連五
+};
+
+constexpr int PATTERN_TABLE_SIZE = 1 << 16;
+
+/**
+ * @brief 棋型查找表
+ *
+ * 索引是落點前後各四格的狀態：低 8 bit 為自己的棋子，高 8 bit 為被擋住的格子（對手或棋盤外），
+ * 中心格不在索引內（視為剛落下的自己棋子）。表格在程式啟動時一次建好。
+ */
+extern const std::array<uint8_t, PATTERN_TABLE_SIZE> patternTable;
+
+/**
+ * @brief 把 9 bit 視窗去掉中心格壓成 8 bit
+ */
+inline uint32_t compressWindow(uint32_t window) { return (window & 0xF) | ((window >> 5) << 4); }
+
+/**
+ * @brief 查詢 isBlack 在 pos 落子後，pos 在 direction 方向上形成的棋型
+ *
+ * @note pos 必須是空位，LineBoard 不需要先放上這顆棋子
+ */
+template <int N>
+inline PatternType patternAt(const LineBoard<N>& lineBoard, int pos, int direction, bool isBlack) {
+    uint32_t own = compressWindow(lineBoard.window(pos, direction, isBlack));
+    uint32_t blocked = compressWindow(lineBoard.blockedWindow(pos, direction, isBlack));
+    return static_cast<PatternType>(patternTable[own | (blocked << 8)]);
+}
+
+#endif  // PATTERN_HPP
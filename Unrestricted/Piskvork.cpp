@@ -0,0 +1,310 @@
+#include "Piskvork.hpp"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <thread>
+
+#include "BatchPlayout.hpp"
+
+namespace {
+
+/**
+ * @brief 讀取一行指令，拆成大寫的指令名稱與其後的參數（去掉 Windows 的換行字元），輸入結束時回傳 false
+ */
+bool readCommand(std::istream& in, std::string& command, std::string& argument) {
+    std::string line;
+    while (std::getline(in, line)) {
+        while (!line.empty() && isspace(static_cast<unsigned char>(line.back()))) {
+            line.pop_back();
+        }
+        std::istringstream stream(line);
+        if (!(stream >> command)) {
+            continue;  // 空行
+        }
+        std::transform(command.begin(), command.end(), command.begin(),
+                       [](unsigned char c) { return static_cast<char>(toupper(c)); });
+        std::getline(stream >> std::ws, argument);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief 處理任何時候都可能出現的 INFO 與 ABOUT，回傳 true 表示已處理
+ */
+bool handleCommon(const std::string& command, const std::string& argument, std::ostream& out,
+                  MatchSettings& settings) {
+    if (command == "INFO") {
+        // INFO 不需要回應；rule 等其他鍵目前不使用
+        std::istringstream stream(argument);
+        std::string key;
+        long long value;
+        if (stream >> key >> value) {
+            int milliseconds = static_cast<int>(std::clamp<long long>(value, 0, INT_MAX));
+            if (key == "timeout_turn") {
+                settings.timer.setTurnLimit(milliseconds);
+            } else if (key == "timeout_match") {
+                settings.timer.setMatchLimit(milliseconds);
+            } else if (key == "time_left") {
+                settings.timer.setTimeLeft(milliseconds);
+            } else if (key == "max_memory") {
+                settings.maxMemory = static_cast<size_t>(std::max<long long>(value, 0));
+            }
+        }
+        return true;
+    }
+    if (command == "ABOUT") {
+        out << "name=\"Unrestricted\", version=\"1.0\"" << std::endl;
+        return true;
+    }
+    return false;
+}
+
+}  // namespace
+
+template <int N>
+Piskvork<N>::Piskvork(std::istream& in, std::ostream& out, MatchSettings& settings)
+    : in(in),
+      out(out),
+      settings(settings),
+      ai(PLAYOUT_BATCH, std::max(1u, std::thread::hardware_concurrency()), searchMode::TREE_PARALLEL) {
+    book.open(DEFAULT_BOOK_PATH);
+    reset();
+}
+
+template <int N>
+int Piskvork<N>::run() {
+    std::string command, argument;
+    while (readCommand(in, command, argument)) {
+        Clock::time_point received = Clock::now();
+        if (handleCommon(command, argument, out, settings)) {
+            continue;
+        }
+        if (command == "START") {
+            int size = atoi(argument.c_str());
+            if (size == N) {
+                reset();
+                out << "OK" << std::endl;
+            } else if (size > 0) {
+                return size;
+            } else {
+                out << "ERROR unsupported board size " << argument << std::endl;
+            }
+        } else if (command == "RESTART") {
+            reset();
+            out << "OK" << std::endl;
+        } else if (command == "BEGIN") {
+            think(received);
+        } else if (command == "TURN") {
+            Position move;
+            if (!parseMove(argument, move) || !isEmpty(move)) {
+                out << "ERROR invalid move " << argument << std::endl;
+                continue;
+            }
+            play(move);
+            think(received);
+        } else if (command == "BOARD") {
+            if (readBoard()) {
+                think(received);
+            } else {
+                out << "ERROR invalid board" << std::endl;
+            }
+        } else if (command == "TAKEBACK") {
+            Position move;
+            if (!parseMove(argument, move) || moves.empty() || moves.back().x != move.x ||
+                moves.back().y != move.y) {
+                out << "ERROR invalid takeback " << argument << std::endl;
+                continue;
+            }
+            moves.pop_back();
+            rebuild();
+            out << "OK" << std::endl;
+        } else if (command == "END") {
+            return 0;
+        } else {
+            out << "UNKNOWN " << command << std::endl;
+        }
+    }
+    return 0;
+}
+
+template <int N>
+void Piskvork<N>::reset() {
+    moves.clear();
+    rebuild();
+    settings.timer.newGame();
+}
+
+template <int N>
+bool Piskvork<N>::parseMove(const std::string& text, Position& move) {
+    return sscanf(text.c_str(), "%d,%d", &move.x, &move.y) == 2 && move.x >= 0 && move.x < N && move.y >= 0 &&
+           move.y < N;
+}
+
+template <int N>
+bool Piskvork<N>::isEmpty(Position move) const {
+    return !Board<N>::getBit(root->boardBlack, move) && !Board<N>::getBit(root->boardWhite, move);
+}
+
+template <int N>
+void Piskvork<N>::play(Position move) {
+    moves.push_back(move);
+    root = ai.advanceRoot(root, move);
+}
+
+template <int N>
+void Piskvork<N>::rebuild() {
+    root = ai.createRoot();
+    for (const Position& move : moves) {
+        root = ai.advanceRoot(root, move);
+    }
+}
+
+template <int N>
+bool Piskvork<N>::readBoard() {
+    std::vector<Position> own, opponent;
+    std::vector<bool> taken(Board<N>::CELLS, false);
+    bool valid = true;
+    std::string line;
+    // 即使有錯誤也要讀到 DONE，後面的行才不會被當成指令
+    while (std::getline(in, line)) {
+        if (line.compare(0, 4, "DONE") == 0) {
+            break;
+        }
+        Position move;
+        int field = 0;
+        if (sscanf(line.c_str(), "%d,%d,%d", &move.x, &move.y, &field) != 3 || move.x < 0 || move.x >= N ||
+            move.y < 0 || move.y >= N || taken[Board<N>::index(move)]) {
+            valid = false;
+            continue;
+        }
+        taken[Board<N>::index(move)] = true;
+        if (field == 1) {
+            own.push_back(move);
+        } else if (field == 2) {
+            opponent.push_back(move);
+        } else {
+            valid = false;  // 3 只用於連續對局模式，不支援
+        }
+    }
+    // 輪到自己下：雙方棋子一樣多時自己是黑方，對手多一顆時自己是白方
+    const std::vector<Position>* black = nullptr;
+    const std::vector<Position>* white = nullptr;
+    if (own.size() == opponent.size()) {
+        black = &own;
+        white = &opponent;
+    } else if (opponent.size() == own.size() + 1) {
+        black = &opponent;
+        white = &own;
+    } else {
+        valid = false;
+    }
+    if (!valid) {
+        return false;
+    }
+    // 只知道棋子、不知道原本的手順，以黑白交替的順序重建出相同的局面
+    moves.clear();
+    for (size_t i = 0; i < black->size(); i++) {
+        moves.push_back((*black)[i]);
+        if (i < white->size()) {
+            moves.push_back((*white)[i]);
+        }
+    }
+    rebuild();
+    return true;
+}
+
+template <int N>
+void Piskvork<N>::think(Clock::time_point received) {
+    if (root->isWin || static_cast<int>(moves.size()) == Board<N>::CELLS) {
+        out << "ERROR the game is over" << std::endl;
+        return;
+    }
+    int budget = settings.timer.moveBudget();
+    Clock::time_point deadline = received + std::chrono::milliseconds(budget);
+    Position move = book.probe(root);
+    if (move.x >= 0) {
+        out << "MESSAGE book move" << std::endl;
+    } else if (moves.empty()) {
+        move = {N / 2, N / 2};  // 空棋盤沒有候選點可以搜尋
+    } else {
+        if (budget >= THREAT_SEARCH_MIN_MS) {
+            move = threats.findWin(root);
+            if (move.x >= 0) {
+                out << "MESSAGE forced win by continuous threats" << std::endl;
+            }
+        }
+        if (move.x < 0) {
+            // max_memory 可能在任何時候更新，搜尋前才換算成搜尋樹的上限（0 表示不限制）
+            size_t limit = settings.maxMemory;
+            ai.setMemoryBudget(limit == 0 ? 0 : std::max(limit, PROCESS_RESERVE_BYTES + 1) - PROCESS_RESERVE_BYTES);
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+            int iterations = ai.runFor(root, static_cast<int>(std::max<long long>(remaining, 1)));
+            Node<N>* best = ai.bestChild(root);
+            if (best != nullptr) {
+                move = best->lastMove;
+                out << "MESSAGE " << iterations << " iterations, " << best->visits << " visits on the chosen move"
+                    << std::endl;
+            } else {
+                // 沒有任何與棋子相鄰的空位時（不應發生）下第一個空位，也不能不回應
+                for (int pos = 0; pos < Board<N>::CELLS && move.x < 0; pos++) {
+                    if (isEmpty(Board<N>::LOOKUP_TABLE[pos])) {
+                        move = Board<N>::LOOKUP_TABLE[pos];
+                    }
+                }
+            }
+        }
+    }
+    out << move.x << "," << move.y << std::endl;
+    settings.timer.moveFinished(
+        static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - received).count()));
+    // 著手送出後才推進搜尋樹，回收舊樹的時間不算在這一步
+    play(move);
+}
+
+int runPiskvork(std::istream& in, std::ostream& out) {
+    MatchSettings settings;
+    std::string command, argument;
+    int size = 0;  // 0 表示還在等待 START
+    while (true) {
+        if (size == 0) {
+            if (!readCommand(in, command, argument) || command == "END") {
+                return 0;
+            }
+            if (handleCommon(command, argument, out, settings)) {
+                continue;
+            }
+            if (command != "START") {
+                out << "ERROR expected START" << std::endl;
+                continue;
+            }
+            size = atoi(argument.c_str());
+        }
+        if (size != 9 && size != 15 && size != 19) {
+            out << "ERROR unsupported board size " << size << std::endl;
+            size = 0;
+            continue;
+        }
+        out << "OK" << std::endl;
+        if (size == 9) {
+            size = Piskvork<9>(in, out, settings).run();
+        } else if (size == 15) {
+            size = Piskvork<15>(in, out, settings).run();
+        } else {
+            size = Piskvork<19>(in, out, settings).run();
+        }
+        if (size == 0) {
+            return 0;
+        }
+    }
+}
+
+template class Piskvork<9>;
+template class Piskvork<15>;
+template class Piskvork<19>;
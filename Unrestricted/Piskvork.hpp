@@ -0,0 +1,84 @@
+#ifndef PISKVORK_HPP
+#define PISKVORK_HPP
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Bitboard.hpp"
+#include "MCTS.hpp"
+#include "Node.hpp"
+#include "OpeningBook.hpp"
+#include "ThreatSearch.hpp"
+#include "TimeManager.hpp"
+
+/**
+ * @brief 以 INFO 設定、換棋盤大小（新的 START）時保留的比賽設定
+ */
+struct MatchSettings {
+    TimeManager timer;
+    size_t maxMemory = 0;  ///< max_memory：整個行程的記憶體上限（位元組），0 表示不限制
+};
+
+/**
+ * @brief Gomocup / Piskvork 引擎協定（以行為單位的文字指令）的 N x N 前端
+ *
+ * 支援 START、RESTART、BEGIN、TURN、BOARD、TAKEBACK、INFO、ABOUT、END。座標為 "x,y"，直接對應 Position。
+ * 每一步依序嘗試開局庫、天元（空棋盤）、連續威脅搜尋，最後以 MCTS 搜尋到 TimeManager 給的期限為止；
+ * 期限從收到指令的那一刻起算，輸出著手後才推進搜尋樹，推進時回收舊樹的時間不會算進這一步。
+ * 協定不允許在對手的回合思考，所以不使用 pondering。
+ *
+ * 樣板只在 Piskvork.cpp 中對支援的棋盤大小（9、15、19）明確實例化。
+ */
+template <int N>
+class Piskvork {
+   public:
+    Piskvork(std::istream& in, std::ostream& out, MatchSettings& settings);
+
+    /**
+     * @brief 處理 START 之後的指令
+     *
+     * @return int 0 表示收到 END 或輸入結束；否則為新的 START 要求的棋盤大小（由 runPiskvork 切換棋盤）
+     */
+    int run();
+
+   private:
+    using Clock = std::chrono::steady_clock;
+    /// 可用時間少於此值時略過連續威脅搜尋，避免它吃掉整步的時間
+    static constexpr int THREAT_SEARCH_MIN_MS = 1000;
+    /// max_memory 中留給搜尋樹以外（程式、堆疊、開局庫）的部分
+    static constexpr size_t PROCESS_RESERVE_BYTES = 16 << 20;
+
+    std::istream& in;
+    std::ostream& out;
+    MatchSettings& settings;
+    MCTS<N> ai;
+    ThreatSearch<N> threats;
+    OpeningBook<N> book;
+    Node<N>* root;
+    std::vector<Position> moves;  ///< 目前局面的著手順序，黑方先下
+
+    void reset();
+    /// @brief 解析 "x,y"（可以帶有 ",field" 等後綴），超出棋盤時回傳 false
+    static bool parseMove(const std::string& text, Position& move);
+    bool isEmpty(Position move) const;
+    void play(Position move);
+    /// @brief 依 moves 重建根節點（BOARD、TAKEBACK 之後使用），原本的搜尋樹全部捨棄
+    void rebuild();
+    /// @brief 讀取 BOARD 指令到 DONE 為止的棋子，成功時以黑白交替的順序重建局面
+    bool readBoard();
+    /// @brief 選出輪到自己的著手並輸出，received 是收到指令的時間
+    void think(Clock::time_point received);
+};
+
+/**
+ * @brief 以 in / out 執行 Piskvork 協定直到收到 END，依 START 要求的大小切換 Piskvork<9 / 15 / 19>
+ */
+int runPiskvork(std::istream& in, std::ostream& out);
+
+extern template class Piskvork<9>;
+extern template class Piskvork<15>;
+extern template class Piskvork<19>;
+
+#endif  // PISKVORK_HPP
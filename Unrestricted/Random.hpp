@@ -0,0 +1,58 @@
+#ifndef RANDOM_HPP
+#define RANDOM_HPP
+
+#include <stdint.h>
+
+/**
+ * @brief splitmix64：把 state 往前推一步並輸出一個打散過的 64 bit 值
+ */
+constexpr uint64_t splitMix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * @brief playout 用的亂數產生器 (xoshiro256**)，狀態只有 32 bytes
+ *
+ * 每一次 playout 都以 (種子, iteration 編號, 該 iteration 內的第幾次 playout) 建立自己的亂數流，
+ * 因此結果只取決於這三個數字，與 playout 被哪個執行緒、以什麼順序執行無關。
+ * 符合 UniformRandomBitGenerator，可以直接交給 <random> 的分佈使用。
+ */
+class PlayoutRng {
+   private:
+    uint64_t state[4];
+
+    static constexpr uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+   public:
+    using result_type = uint64_t;
+
+    PlayoutRng(uint64_t seed, uint64_t iteration, uint64_t slot) {
+        // 以 splitmix64 依序把三個數字混進 key，再展開成四個狀態字
+        uint64_t key = seed;
+        key = splitMix64(key) + iteration;
+        key = splitMix64(key) + slot;
+        for (uint64_t& word : state) {
+            word = splitMix64(key);
+        }
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return UINT64_MAX; }
+
+    result_type operator()() {
+        uint64_t result = rotl(state[1] * 5, 7) * 9;
+        uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+        return result;
+    }
+};
+
+#endif  // RANDOM_HPP
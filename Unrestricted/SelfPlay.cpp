@@ -0,0 +1,102 @@
+#include "SelfPlay.hpp"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "BatchPlayout.hpp"
+#include "Bitboard.hpp"
+#include "MCTS.hpp"
+#include "Node.hpp"
+#include "Random.hpp"
+
+template <int N>
+int SelfPlay<N>::run(GameRecord::Writer& writer) {
+    nextGame = 0;
+    written = 0;
+    int workers = options.workers;
+    if (workers <= 0) {
+        workers = std::max(1u, std::thread::hardware_concurrency());
+    }
+    workers = std::min(workers, options.games);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < workers; i++) {
+        threads.emplace_back(&SelfPlay::worker, this, std::ref(writer));
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    return written;
+}
+
+template <int N>
+void SelfPlay<N>::worker(GameRecord::Writer& writer) {
+    GameRecord::Builder builder;
+    for (int game = nextGame.fetch_add(1); game < options.games; game = nextGame.fetch_add(1)) {
+        uint64_t state = options.seed + game;
+        uint64_t seed = splitMix64(state);
+        builder.begin(N, seed);
+        int winner = playGame(seed, builder);
+        if (writer.append(builder.finish(winner))) {
+            written++;
+        }
+    }
+}
+
+template <int N>
+int SelfPlay<N>::playGame(uint64_t seed, GameRecord::Builder& builder) {
+    using Clock = std::chrono::steady_clock;
+    // 每盤棋單執行緒搜尋，平行度來自同時進行的多盤棋
+    MCTS<N> ai(PLAYOUT_BATCH, 1, searchMode::LEAF_PARALLEL);
+    ai.setSeed(seed);
+    PlayoutRng rng(seed, 0, 0);  // 抽樣著手用的亂數流
+    Node<N>* node = ai.createRoot();
+    // 空棋盤沒有候選點可以搜尋，第一手下天元
+    const Position center = {N / 2, N / 2};
+    builder.addMove(Board<N>::index(center), 0, nullptr, 0);
+    node = ai.advanceRoot(node, center);
+
+    GameRecord::VisitEntry visits[Board<N>::CELLS];
+    for (int ply = 1; ply < Board<N>::CELLS; ply++) {
+        auto start = Clock::now();
+        ai.run(node, options.iterations);
+        int childCount = node->childCount;
+        uint64_t samplingTotal = 0;
+        for (int i = 0; i < childCount; i++) {
+            const Node<N>& child = node->children[i];
+            visits[i] = {static_cast<uint16_t>(Board<N>::index(child.lastMove)), 0,
+                         static_cast<uint32_t>(child.visits.load(std::memory_order_relaxed))};
+            if (child.proven != PROVEN_LOSS) {
+                samplingTotal += visits[i].visits;
+            }
+        }
+        Position move = ai.bestChild(node)->lastMove;
+        // 前幾步依訪問次數比例抽樣；已證明的局面與必敗的著手不參與抽樣
+        if (ply < options.samplingMoves && node->proven == UNPROVEN && samplingTotal > 0) {
+            uint64_t pick = rng() % samplingTotal;
+            for (int i = 0; i < childCount; i++) {
+                if (node->children[i].proven == PROVEN_LOSS) continue;
+                if (pick < visits[i].visits) {
+                    move = node->children[i].lastMove;
+                    break;
+                }
+                pick -= visits[i].visits;
+            }
+        }
+        auto micros = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+        builder.addMove(Board<N>::index(move), static_cast<uint32_t>(micros), visits, childCount);
+        node = ai.advanceRoot(node, move);
+        if (node->isWin) {
+            return node->isBlackTurn ? 1 : -1;
+        }
+    }
+    return 0;
+}
+
+template class SelfPlay<9>;
+template class SelfPlay<15>;
+template class SelfPlay<19>;
@@ -0,0 +1,51 @@
+#ifndef SELFPLAY_HPP
+#define SELFPLAY_HPP
+
+#include <stdint.h>
+
+#include <atomic>
+
+#include "GameRecord.hpp"
+
+/// @brief 自我對弈的參數
+struct SelfPlayOptions {
+    int games = 100;
+    int iterations = 2000;  ///< 每一步的 MCTS iteration 數
+    int workers = 0;        ///< 同時進行的對局數，0 代表使用所有硬體執行緒
+    int samplingMoves = 8;  ///< 前幾步依訪問次數比例抽樣而不是取最多訪問的著手，讓對局多樣化
+    uint64_t seed = 1;      ///< 第 i 盤棋的種子由 (seed, i) 決定，與排程無關
+};
+
+/**
+ * @brief 不經過 cin / cout 的多盤平行自我對弈
+ *
+ * 每個 worker 執行緒各自負責一盤棋，每盤棋有自己的 MCTS 與搜尋樹（單執行緒搜尋），
+ * 下完就把棋譜附加到紀錄檔並從共用的計數器領下一盤，長短不一的對局不會讓核心閒置。
+ *
+ * 樣板只在 SelfPlay.cpp 中對支援的棋盤大小（9、15、19）明確實例化。
+ */
+template <int N>
+class SelfPlay {
+   public:
+    explicit SelfPlay(const SelfPlayOptions& options) : options(options) {}
+
+    /**
+     * @brief 下完 options.games 盤棋並寫入 writer，回傳成功寫入的盤數
+     */
+    int run(GameRecord::Writer& writer);
+
+   private:
+    SelfPlayOptions options;
+    std::atomic<int> nextGame{0};
+    std::atomic<int> written{0};
+
+    void worker(GameRecord::Writer& writer);
+    /// @brief 下一盤棋並把著手記錄到 builder，回傳勝方（1 = 黑，-1 = 白，0 = 平手）
+    int playGame(uint64_t seed, GameRecord::Builder& builder);
+};
+
+extern template class SelfPlay<9>;
+extern template class SelfPlay<15>;
+extern template class SelfPlay<19>;
+
+#endif  // SELFPLAY_HPP
@@ -1,70 +1,244 @@
 #pragma once
+#include <atomic>
 #include <condition_variable>
+#include <cstddef>
 #include <functional>
 #include <future>
+#include <memory>
 #include <mutex>
-#include <queue>
+#include <stdexcept>
 #include <thread>
 #include <type_traits>
 #include <vector>
 
+#include "Instrument.hpp"
+
+/**
+ * @brief 忙等時讓出 CPU 管線資源的提示指令
+ */
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+/**
+ * @brief 工作竊取 (work-stealing) 執行緒池
+ *
+ * 每個 worker 有自己的雙端佇列：自己從尾端取（LIFO，資料還在 cache 裡），
+ * 其他 worker 沒事做時從頭端偷（FIFO）。提交固定簽名的 `Task`（函式指標 + 參數指標）
+ * 不需要任何動態配置，工作的記憶體由呼叫端持有。
+ * 閒置的 worker 先自旋（pause 之後改為讓出時間片）一段時間再睡在條件變數上，
+ * 短暫的空檔不需要付出喚醒延遲。
+ */
 class ThreadPool {
+   public:
+    /// 固定簽名的工作，`argument` 指向呼叫端持有的資料
+    struct Task {
+        void (*function)(void*);
+        void* argument;
+#ifdef GOMOKU_INSTRUMENT
+        uint64_t submitted = 0;  ///< 提交時的 cycle 數，用來量測排隊時間
+#endif
+    };
+
    private:
+    static constexpr size_t QUEUE_CAPACITY = 256;  ///< 每個 worker 佇列的容量（2 的冪次）
+    static constexpr int PAUSE_LIMIT = 64;         ///< 只用 pause 指令自旋的次數，之後改為讓出時間片
+    static constexpr int SPIN_LIMIT = 1024;        ///< 進入睡眠前的自旋次數
+
+    struct alignas(64) WorkerQueue {
+        std::atomic_flag lock = ATOMIC_FLAG_INIT;
+        size_t head = 0;  ///< 下一個被偷走的位置
+        size_t tail = 0;  ///< 下一個放入的位置
+        Task tasks[QUEUE_CAPACITY];
+
+        void acquire() {
+            while (lock.test_and_set(std::memory_order_acquire)) {
+                cpuRelax();
+            }
+        }
+        void release() { lock.clear(std::memory_order_release); }
+        bool push(Task task) {
+            acquire();
+            bool ok = tail - head < QUEUE_CAPACITY;
+            if (ok) {
+                tasks[tail++ & (QUEUE_CAPACITY - 1)] = task;
+            }
+            release();
+            return ok;
+        }
+        bool popBack(Task& task) {
+            acquire();
+            bool ok = tail != head;
+            if (ok) {
+                task = tasks[--tail & (QUEUE_CAPACITY - 1)];
+            }
+            release();
+            return ok;
+        }
+        bool popFront(Task& task) {
+            acquire();
+            bool ok = tail != head;
+            if (ok) {
+                task = tasks[head++ & (QUEUE_CAPACITY - 1)];
+            }
+            release();
+            return ok;
+        }
+    };
+
     std::vector<std::thread> workers;
-    std::queue<std::function<void()>> tasks;
-    std::mutex queue_mutex;
+    std::unique_ptr<WorkerQueue[]> queues;
+    size_t queueCount;
+    std::atomic<size_t> nextQueue;     ///< 外部執行緒提交時輪流選擇的佇列
+    std::atomic<int> pendingTasks;     ///< 已提交但尚未被取走的工作數
+    std::atomic<int> sleepingWorkers;  ///< 正在條件變數上等待的 worker 數
+    std::mutex parkMutex;
     std::condition_variable condition;
-    bool stop;
+    std::atomic<bool> stop;
+
+    static int& currentWorker() {
+        thread_local int index = -1;
+        return index;
+    }
+
+    static void backoff(int spins) {
+        if (spins < PAUSE_LIMIT) {
+            cpuRelax();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    bool takeTask(size_t preferred, Task& task) {
+        if (queues[preferred].popBack(task)) {
+            pendingTasks.fetch_sub(1);
+            return true;
+        }
+        for (size_t i = 1; i < queueCount; i++) {
+            if (queues[(preferred + i) % queueCount].popFront(task)) {
+                pendingTasks.fetch_sub(1);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static void runTask(Task& task) {
+        INSTRUMENT_ADD(queuedTasks, 1);
+        INSTRUMENT_ADD(queueWaitCycles, instrument::readCycles() - task.submitted);
+        task.function(task.argument);
+    }
+
+    void workerLoop(size_t index) {
+        currentWorker() = static_cast<int>(index);
+        Task task;
+        while (true) {
+            int spins = 0;
+            while (!takeTask(index, task)) {
+                if (stop.load(std::memory_order_acquire)) return;
+                if (++spins < SPIN_LIMIT) {
+                    backoff(spins);
+                    continue;
+                }
+                // 自旋太久仍沒有工作，改為睡眠等待
+                std::unique_lock<std::mutex> lock(parkMutex);
+                sleepingWorkers.fetch_add(1);
+                condition.wait(lock, [this] { return stop.load() || pendingTasks.load() > 0; });
+                sleepingWorkers.fetch_sub(1);
+                spins = 0;
+            }
+            runTask(task);
+        }
+    }
 
    public:
     explicit ThreadPool(size_t threads);
     ~ThreadPool();
 
+    /**
+     * @brief 提交固定簽名的工作，不做任何動態配置
+     *
+     * 從 worker 內提交時放進自己的佇列，外部執行緒則輪流放到各個佇列；
+     * 所有佇列都滿時直接在呼叫端執行。
+     */
+    void submit(Task task) {
+        INSTRUMENT_ONLY(task.submitted = instrument::readCycles());
+        int self = currentWorker();
+        size_t start = self >= 0 ? static_cast<size_t>(self) : nextQueue.fetch_add(1) % queueCount;
+        pendingTasks.fetch_add(1);
+        bool pushed = false;
+        for (size_t i = 0; i < queueCount && !pushed; i++) {
+            pushed = queues[(start + i) % queueCount].push(task);
+        }
+        if (!pushed) {
+            pendingTasks.fetch_sub(1);
+            task.function(task.argument);
+            return;
+        }
+        if (sleepingWorkers.load() > 0) {
+            std::lock_guard<std::mutex> lock(parkMutex);
+            condition.notify_one();
+        }
+    }
+
+    /**
+     * @brief 等待 counter 歸零；等待期間呼叫端也會幫忙執行佇列裡的工作
+     */
+    void wait(const std::atomic<int>& counter) {
+        Task task;
+        size_t start = nextQueue.load(std::memory_order_relaxed) % queueCount;
+        int spins = 0;
+        while (counter.load(std::memory_order_acquire) > 0) {
+            if (takeTask(start, task)) {
+                runTask(task);
+                spins = 0;
+            } else {
+                backoff(++spins);
+            }
+        }
+    }
+
+    /**
+     * @brief 提交任意可呼叫物件並取得 future（會配置記憶體，不適合用在熱路徑）
+     */
     template <class F, class... Args>
     auto enqueue(F&& f, Args&&... args) -> std::future<typename std::invoke_result_t<F, Args...>> {
         using return_type = typename std::invoke_result_t<F, Args...>;
+        if (stop) throw std::runtime_error("enqueue on stopped ThreadPool");
 
-        auto task = std::make_shared<std::packaged_task<return_type()>>(
-            std::bind(std::forward<F>(f), std::forward<Args>(args)...));
-
+        auto* task = new std::packaged_task<return_type()>(std::bind(std::forward<F>(f), std::forward<Args>(args)...));
         std::future<return_type> res = task->get_future();
-        {
-            std::unique_lock<std::mutex> lock(queue_mutex);
-            if (stop) throw std::runtime_error("enqueue on stopped ThreadPool");
-
-            tasks.emplace([task]() { (*task)(); });
-        }
-        condition.notify_one();
+        submit({[](void* argument) {
+                    auto* task = static_cast<std::packaged_task<return_type()>*>(argument);
+                    (*task)();
+                    delete task;
+                },
+                task});
         return res;
     }
 };
 
 // the constructor just launches some amount of workers
-inline ThreadPool::ThreadPool(size_t threads) : stop(false) {
-    for (size_t i = 0; i < threads; ++i)
-        workers.emplace_back([this] {
-            for (;;) {
-                std::function<void()> task;
-
-                {
-                    std::unique_lock<std::mutex> lock(this->queue_mutex);
-                    this->condition.wait(lock, [this] { return this->stop || !this->tasks.empty(); });
-                    if (this->stop && this->tasks.empty()) return;
-                    task = std::move(this->tasks.front());
-                    this->tasks.pop();
-                }
-
-                task();
-            }
-        });
+inline ThreadPool::ThreadPool(size_t threads)
+    : queues(new WorkerQueue[threads > 0 ? threads : 1]),
+      queueCount(threads > 0 ? threads : 1),
+      nextQueue(0),
+      pendingTasks(0),
+      sleepingWorkers(0),
+      stop(false) {
+    for (size_t i = 0; i < threads; ++i) workers.emplace_back([this, i] { workerLoop(i); });
 }
 
 // the destructor joins all threads
 inline ThreadPool::~ThreadPool() {
     {
-        std::unique_lock<std::mutex> lock(queue_mutex);
+        std::lock_guard<std::mutex> lock(parkMutex);
         stop = true;
     }
     condition.notify_all();
     for (std::thread& worker : workers) worker.join();
-}
\ No newline at end of file
+}
@@ -0,0 +1,334 @@
+#include "ThreatSearch.hpp"
+
+#include <stdint.h>
+
+#include <cstring>
+
+#include "Zobrist.hpp"
+
+namespace {
+// 同一局面的 VCF 與 VCT 結果分開記錄
+constexpr uint64_t VCF_SALT = 0x9E3779B97F4A7C15ULL;
+constexpr uint64_t VCT_SALT = 0xC2B2AE3D27D4EB4FULL;
+}  // namespace
+
+template <int N>
+ThreatSearch<N>::ThreatSearch(size_t nodeBudget, size_t memoEntries) : nodeBudget(nodeBudget) {
+    size_t size = 1;
+    while (size * 2 <= memoEntries) size *= 2;
+    memo.resize(size);
+    memoMask = size - 1;
+}
+
+template <int N>
+Position ThreatSearch<N>::findWin(const Node<N>* node) {
+    memcpy(boardBlack, node->boardBlack, sizeof(boardBlack));
+    memcpy(boardWhite, node->boardWhite, sizeof(boardWhite));
+    lineBoard.load(boardBlack, boardWhite);
+    hash = node->hash;
+    nodes = 0;
+    exhausted = false;
+    const bool attacker = !node->isBlackTurn;
+
+    // 攻方已經能連五就直接下；守方有連五點時攻方必須先擋，兩個以上就擋不住了
+    uint64_t area[BITBOARD_COUNT];
+    threatArea(area);
+    int five = -1, forcedBlock = -1, defenderFives = 0;
+    Board<N>::forEachBit(area, [&](int pos) {
+        if (five < 0 && bestPattern(pos, attacker) == PATTERN_FIVE) {
+            five = pos;
+        }
+        if (bestPattern(pos, !attacker) == PATTERN_FIVE) {
+            forcedBlock = pos;
+            defenderFives++;
+        }
+    });
+    if (five >= 0) {
+        return Board<N>::LOOKUP_TABLE[five];
+    }
+    if (defenderFives >= 2) {
+        return {-1, -1};
+    }
+    // 深度 0 只找 VCF，之後逐步允許更多活三，先找到的手順也是最短的
+    for (int depth = 0; depth <= VCT_DEPTH && !exhausted; depth++) {
+        int move;
+        if (vct(attacker, depth, forcedBlock, &move)) {
+            return Board<N>::LOOKUP_TABLE[move];
+        }
+    }
+    return {-1, -1};
+}
+
+template <int N>
+void ThreatSearch<N>::place(int pos, bool isBlack) {
+    setBit(isBlack ? boardBlack : boardWhite, pos);
+    lineBoard.place(pos, isBlack);
+    hash ^= zobristKey<N>(pos, isBlack);
+}
+
+template <int N>
+void ThreatSearch<N>::remove(int pos, bool isBlack) {
+    uint64_t* board = isBlack ? boardBlack : boardWhite;
+    board[pos >> 6] &= ~(1ULL << (pos & 63));
+    lineBoard.remove(pos, isBlack);
+    hash ^= zobristKey<N>(pos, isBlack);
+}
+
+template <int N>
+PatternType ThreatSearch<N>::bestPattern(int pos, bool isBlack) const {
+    PatternType best = PATTERN_NONE;
+    for (int direction = 0; direction < DIRECTION_COUNT; direction++) {
+        PatternType pattern = patternAt(lineBoard, pos, direction, isBlack);
+        if (pattern > best) {
+            best = pattern;
+        }
+    }
+    return best;
+}
+
+template <int N>
+int ThreatSearch<N>::linePoints(int pos, bool isBlack, PatternType minimum, int* points) const {
+    int count = 0;
+    Position center = Board<N>::LOOKUP_TABLE[pos];
+    for (int direction = 0; direction < DIRECTION_COUNT; direction++) {
+        for (int k = -4; k <= 4; k++) {
+            int x = center.x + k * DIRECTION[direction].x, y = center.y + k * DIRECTION[direction].y;
+            if (k == 0 || x < 0 || x >= N || y < 0 || y >= N) continue;
+            int cell = x * N + y;
+            if (getBit(boardBlack, cell) || getBit(boardWhite, cell)) continue;
+            if (patternAt(lineBoard, cell, direction, isBlack) >= minimum) {
+                points[count++] = cell;
+            }
+        }
+    }
+    return count;
+}
+
+template <int N>
+void ThreatSearch<N>::threatArea(uint64_t* out) const {
+    uint64_t occupied[BITBOARD_COUNT], near[BITBOARD_COUNT];
+    for (int i = 0; i < BITBOARD_COUNT; i++) {
+        occupied[i] = (boardBlack[i] | boardWhite[i]) & Board<N>::VALID_MASK[i];
+    }
+    Board<N>::dilate(occupied, near);
+    Board<N>::dilate(near, out);
+    for (int i = 0; i < BITBOARD_COUNT; i++) {
+        out[i] &= ~occupied[i];
+    }
+}
+
+template <int N>
+bool ThreatSearch<N>::nextBudget() {
+    if (++nodes > nodeBudget) {
+        exhausted = true;
+    }
+    return !exhausted;
+}
+
+template <int N>
+typename ThreatSearch<N>::MemoEntry* ThreatSearch<N>::probe(uint64_t key) {
+    MemoEntry* entry = &memo[key & memoMask];
+    return entry->key == key ? entry : nullptr;
+}
+
+template <int N>
+void ThreatSearch<N>::record(uint64_t key, int depth, bool win, int move) {
+    // 節點數用完時的失敗只是沒搜完，不能當成結論
+    if (!win && exhausted) {
+        return;
+    }
+    MemoEntry& entry = memo[key & memoMask];
+    entry.key = key;
+    entry.move = static_cast<int16_t>(move);
+    entry.depth = static_cast<int8_t>(depth);
+    entry.win = win;
+}
+
+template <int N>
+template <class Continuation>
+bool ThreatSearch<N>::defend(bool attacker, int pos, Continuation&& next) {
+    place(pos, !attacker);
+    int fives[MAX_POINTS];
+    int fiveCount = linePoints(pos, !attacker, PATTERN_FIVE, fives);
+    bool win = fiveCount < 2 && next(fiveCount == 1 ? fives[0] : -1);
+    remove(pos, !attacker);
+    return win;
+}
+
+template <int N>
+bool ThreatSearch<N>::vcf(bool attacker, int depth, int forcedBlock, int* move) {
+    if (depth == 0 || !nextBudget()) {
+        return false;
+    }
+    const uint64_t key = hash ^ VCF_SALT;
+    if (MemoEntry* entry = probe(key)) {
+        if (entry->win) {
+            *move = entry->move;
+            return true;
+        }
+        if (entry->depth >= depth) {
+            return false;
+        }
+    }
+    int candidates[Board<N>::CELLS];
+    int count = 0;
+    if (forcedBlock >= 0) {
+        candidates[count++] = forcedBlock;
+    } else {
+        uint64_t area[BITBOARD_COUNT];
+        threatArea(area);
+        Board<N>::forEachBit(area, [&](int pos) {
+            if (bestPattern(pos, attacker) >= PATTERN_FOUR) candidates[count++] = pos;
+        });
+    }
+    // 先找直接成活四或雙四的著手，再展開只有一個連五點的衝四，避免在長手順裡繞遠路
+    int blocks[Board<N>::CELLS];
+    int fourCount = 0;
+    for (int i = 0; i < count; i++) {
+        int pos = candidates[i];
+        PatternType pattern = bestPattern(pos, attacker);
+        if (pattern < PATTERN_FOUR) continue;  // 擋守方的連五點時，這一步也必須是衝四
+        place(pos, attacker);
+        int fives[MAX_POINTS];
+        int fiveCount = linePoints(pos, attacker, PATTERN_FIVE, fives);
+        remove(pos, attacker);
+        if (pattern == PATTERN_FIVE || fiveCount >= 2) {
+            record(key, depth, true, pos);
+            *move = pos;
+            return true;
+        }
+        candidates[fourCount] = pos;
+        blocks[fourCount++] = fives[0];
+    }
+    for (int i = 0; i < fourCount; i++) {
+        int pos = candidates[i];
+        int next;
+        place(pos, attacker);
+        bool win = defend(attacker, blocks[i], [&](int block) { return vcf(attacker, depth - 1, block, &next); });
+        remove(pos, attacker);
+        if (win) {
+            record(key, depth, true, pos);
+            *move = pos;
+            return true;
+        }
+        if (exhausted) {
+            break;
+        }
+    }
+    record(key, depth, false, -1);
+    return false;
+}
+
+template <int N>
+bool ThreatSearch<N>::vct(bool attacker, int depth, int forcedBlock, int* move) {
+    if (vcf(attacker, VCF_DEPTH, forcedBlock, move)) {
+        return true;
+    }
+    if (depth == 0 || !nextBudget()) {
+        return false;
+    }
+    const uint64_t key = hash ^ VCT_SALT;
+    if (MemoEntry* entry = probe(key)) {
+        if (entry->win) {
+            *move = entry->move;
+            return true;
+        }
+        if (entry->depth >= depth) {
+            return false;
+        }
+    }
+    int candidates[Board<N>::CELLS];
+    int count = 0;
+    uint64_t area[BITBOARD_COUNT];
+    threatArea(area);
+    if (forcedBlock >= 0) {
+        candidates[count++] = forcedBlock;
+    } else {
+        Board<N>::forEachBit(area, [&](int pos) {
+            if (bestPattern(pos, attacker) >= PATTERN_OPEN_THREE) candidates[count++] = pos;
+        });
+    }
+    for (int i = 0; i < count; i++) {
+        int pos = candidates[i];
+        if (bestPattern(pos, attacker) < PATTERN_OPEN_THREE) continue;  // 擋守方的連五點時，這一步也必須是威脅
+        place(pos, attacker);
+        int fives[MAX_POINTS];
+        int fiveCount = linePoints(pos, attacker, PATTERN_FIVE, fives);
+        int next;
+        auto deeper = [&](int block) { return vct(attacker, depth - 1, block, &next); };
+        bool win;
+        if (fiveCount >= 2) {
+            win = true;
+        } else if (fiveCount == 1) {
+            win = defend(attacker, fives[0], deeper);
+        } else {
+            win = threeWins(attacker, pos, depth);
+        }
+        remove(pos, attacker);
+        if (win) {
+            record(key, depth, true, pos);
+            *move = pos;
+            return true;
+        }
+        if (exhausted) {
+            break;
+        }
+    }
+    record(key, depth, false, -1);
+    return false;
+}
+
+template <int N>
+bool ThreatSearch<N>::threeWins(bool attacker, int pos, int depth) {
+    // 守方可以擋在攻方的任一個成四點，或是自己衝四搶先手
+    int replies[Board<N>::CELLS];
+    int replyCount = linePoints(pos, attacker, PATTERN_FOUR, replies);
+    if (replyCount == 0) {
+        return false;  // 活三已經被擋死，不再是威脅
+    }
+    const int blocks = replyCount;
+    uint64_t area[BITBOARD_COUNT];
+    threatArea(area);
+    Board<N>::forEachBit(area, [&](int cell) {
+        if (bestPattern(cell, !attacker) < PATTERN_FOUR) return;
+        for (int i = 0; i < blocks; i++) {
+            if (replies[i] == cell) return;
+        }
+        replies[replyCount++] = cell;
+    });
+    int next;
+    for (int i = 0; i < replyCount; i++) {
+        int reply = replies[i];
+        place(reply, !attacker);
+        int fives[MAX_POINTS];
+        int fiveCount = linePoints(reply, !attacker, PATTERN_FIVE, fives);
+        bool win = false;
+        if (fiveCount == 0) {
+            win = vct(attacker, depth - 1, -1, &next);
+        } else if (fiveCount == 1) {
+            // 守方衝四：攻方先擋，擋完若成四就照衝四處理，否則活三仍在，守方要再應一次
+            int block = fives[0];
+            place(block, attacker);
+            int attackerFives[MAX_POINTS];
+            int attackerFiveCount = linePoints(block, attacker, PATTERN_FIVE, attackerFives);
+            if (attackerFiveCount >= 2) {
+                win = true;
+            } else if (attackerFiveCount == 1) {
+                win = defend(attacker, attackerFives[0],
+                             [&](int forced) { return vct(attacker, depth - 1, forced, &next); });
+            } else {
+                win = threeWins(attacker, pos, depth);
+            }
+            remove(block, attacker);
+        }
+        remove(reply, !attacker);
+        if (!win) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template class ThreatSearch<9>;
+template class ThreatSearch<15>;
+template class ThreatSearch<19>;
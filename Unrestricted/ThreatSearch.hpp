@@ -0,0 +1,115 @@
+#ifndef THREATSEARCH_HPP
+#define THREATSEARCH_HPP
+
+#include <stdint.h>
+
+#include <cstddef>
+#include <vector>
+
+#include "Bitboard.hpp"
+#include "LineBoard.hpp"
+#include "Node.hpp"
+#include "Pattern.hpp"
+
+/**
+ * @brief 連續威脅 (threat-space) 必勝搜尋：VCF（連續衝四）與 VCT（連續活三、衝四）
+ *
+ * 只展開攻方的威脅著手，守方只考慮必要的應手，因此能在毫秒內找到隨機 playout 很難找到的必勝手順：
+ * - 衝四：守方唯一的應手是攻方的連五點；攻方同時有兩個連五點（活四、雙四）即獲勝
+ * - 活三：守方的應手是該著手所在各線上攻方的成四點，以及守方自己能衝四的點（反擊）
+ * - 守方有連五點時攻方必須先擋，而且擋的這一步本身也必須是威脅，否則失去先手
+ *
+ * 衝四的搜尋是完全的（守方沒有其他選擇）；活三的應手只取上述集合，是一般威脅空間搜尋的近似。
+ * 以 Zobrist 雜湊記錄已搜尋局面的結果（失敗結果附帶當時的剩餘深度），並以節點數上限控制耗時。
+ * 樣板只在 ThreatSearch.cpp 中對支援的棋盤大小（9、15、19）明確實例化。
+ */
+template <int N>
+class ThreatSearch {
+   public:
+    static constexpr size_t DEFAULT_NODE_BUDGET = 100000;  ///< 每次 findWin 最多展開的節點數
+    static constexpr size_t DEFAULT_MEMO_ENTRIES = 1 << 18;
+    static constexpr int VCF_DEPTH = 16;  ///< 攻方最多連續衝四的次數
+    static constexpr int VCT_DEPTH = 4;   ///< 轉入 VCF 之前攻方最多連續威脅的次數
+
+    explicit ThreatSearch(size_t nodeBudget = DEFAULT_NODE_BUDGET, size_t memoEntries = DEFAULT_MEMO_ENTRIES);
+
+    /**
+     * @brief 找出輪到的一方（落下 node->lastMove 的另一方）以連續威脅取勝的第一步
+     *
+     * 先找 VCF，再逐步加深 VCT 的深度；節點數用完就放棄。
+     *
+     * @return Position 必勝手順的第一步；找不到時為 {-1, -1}
+     */
+    Position findWin(const Node<N>* node);
+
+    /// @brief 最近一次 findWin 展開的節點數
+    size_t nodesSearched() const { return nodes; }
+
+   private:
+    static constexpr int BITBOARD_COUNT = Board<N>::BITBOARD_COUNT;
+    static constexpr int MAX_POINTS = 4 * 8;  ///< 通過一格的四條線上、前後各四格的格子數
+    /// 四個方向的單位位移，與 LineBoard 的方向順序相同
+    static constexpr Position DIRECTION[DIRECTION_COUNT] = {{0, 1}, {1, 0}, {1, 1}, {1, -1}};
+
+    struct MemoEntry {
+        uint64_t key = 0;
+        int16_t move = -1;  ///< 成功時的第一步
+        int8_t depth = 0;   ///< 失敗時的剩餘深度，深度不超過它的搜尋都會失敗
+        bool win = false;
+    };
+
+    std::vector<MemoEntry> memo;
+    size_t memoMask;
+    size_t nodeBudget;
+    size_t nodes = 0;
+    bool exhausted = false;  ///< 節點數已用完，之後的失敗結果不可記錄
+
+    uint64_t boardBlack[BITBOARD_COUNT];
+    uint64_t boardWhite[BITBOARD_COUNT];
+    LineBoard<N> lineBoard;
+    uint64_t hash = 0;
+
+    void place(int pos, bool isBlack);
+    void remove(int pos, bool isBlack);
+    /// @brief isBlack 在 pos 落子後四個方向中最強的棋型
+    PatternType bestPattern(int pos, bool isBlack) const;
+    /**
+     * @brief 通過 pos 的四條線上（前後各四格）isBlack 落子後棋型至少為 minimum 的空位
+     *
+     * 取 PATTERN_FIVE 即是連五點，取 PATTERN_FOUR 即是能成四的點。
+     */
+    int linePoints(int pos, bool isBlack, PatternType minimum, int* points) const;
+    /// @brief 所有與棋子距離兩格以內的空位，威脅著手一定落在其中
+    void threatArea(uint64_t* out) const;
+    bool nextBudget();
+    MemoEntry* probe(uint64_t key);
+    void record(uint64_t key, int depth, bool win, int move);
+    /**
+     * @brief 攻方連續衝四能否獲勝
+     *
+     * @param forcedBlock 守方的連五點（攻方必須先擋），沒有時為 -1
+     * @param move 成功時寫入第一步
+     */
+    bool vcf(bool attacker, int depth, int forcedBlock, int* move);
+    /**
+     * @brief 攻方落在 pos 的威脅由守方應手後，交給 next 繼續搜尋
+     *
+     * 守方落在 pos；若因此產生連五點，攻方下一步必須擋在該點（以 forcedBlock 傳給 next），兩個以上即失敗。
+     */
+    template <class Continuation>
+    bool defend(bool attacker, int pos, Continuation&& next);
+    /**
+     * @brief 攻方剛在 pos 形成活三（沒有連五點）時，守方的每一種應手是否都擋不住
+     */
+    bool threeWins(bool attacker, int pos, int depth);
+    /**
+     * @brief 攻方以活三、衝四在 depth 次威脅之內轉入 VCF 能否獲勝（depth 為 0 時等同 VCF）
+     */
+    bool vct(bool attacker, int depth, int forcedBlock, int* move);
+};
+
+extern template class ThreatSearch<9>;
+extern template class ThreatSearch<15>;
+extern template class ThreatSearch<19>;
+
+#endif  // THREATSEARCH_HPP
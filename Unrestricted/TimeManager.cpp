@@ -0,0 +1,28 @@
+#include "TimeManager.hpp"
+
+#include <algorithm>
+
+void TimeManager::newGame() {
+    timeLeft = -1;
+    used = 0;
+    moves = 0;
+}
+
+int TimeManager::moveBudget() const {
+    // 單步時限為 0 表示盡快回應
+    int budget = turnLimit > 0 ? turnLimit - margin(turnLimit) : MIN_MOVE_MS;
+    if (matchLimit > 0) {
+        int left = timeLeft >= 0 ? timeLeft : matchLimit - used;
+        int movesToGo = std::max(MIN_MOVES_TO_GO, EXPECTED_MOVES - moves);
+        budget = std::min(budget, (left - margin(left)) / movesToGo);
+    }
+    return std::max(budget, MIN_MOVE_MS);
+}
+
+void TimeManager::moveFinished(int elapsed) {
+    used += elapsed;
+    moves++;
+    if (timeLeft >= 0) {
+        timeLeft = std::max(0, timeLeft - elapsed);
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef TIMEMANAGER_HPP
+#define TIMEMANAGER_HPP
+
+/**
+ * @brief 比賽用的時間分配：把整盤棋的時間分給每一步，並保證每一步都在單步時限內回應
+ *
+ * 單步的可用時間取下列兩者中較小的一個，兩者都先扣掉安全邊際：
+ * - 單步時限 (timeout_turn)
+ * - 整盤剩餘時間 (time_left 或 timeout_match 扣掉自己記錄的用時) 平均分給預估還要下的步數
+ *
+ * 安全邊際涵蓋收到指令到開始搜尋、搜尋結束到輸出著手之間的時間，以及搜尋迴圈檢查時鐘的間隔。
+ * 所有時間都以毫秒為單位，0 代表沒有限制（單步時限為 0 則代表盡快回應）。
+ */
+class TimeManager {
+   public:
+    static constexpr int DEFAULT_TURN_MS = 5000;  ///< 沒有收到 timeout_turn 時的單步時限
+    static constexpr int MIN_MARGIN_MS = 50;      ///< 安全邊際的固定部分
+    static constexpr int MARGIN_PERCENT = 2;      ///< 安全邊際隨時限成長的部分（百分比）
+    static constexpr int EXPECTED_MOVES = 40;     ///< 預估一盤棋自己要下的步數
+    static constexpr int MIN_MOVES_TO_GO = 10;    ///< 超過預估步數後，剩餘時間至少再分這麼多步
+    static constexpr int MIN_MOVE_MS = 1;         ///< 每一步至少搜尋的時間
+
+    void setTurnLimit(int milliseconds) { turnLimit = milliseconds; }
+    void setMatchLimit(int milliseconds) { matchLimit = milliseconds; }
+    /// @brief 管理程式告知的整盤剩餘時間，優先於自己累計的用時
+    void setTimeLeft(int milliseconds) { timeLeft = milliseconds; }
+    int getTurnLimit() const { return turnLimit; }
+
+    /**
+     * @brief 新的一盤棋開始，歸零用時與步數（時限設定保留）
+     */
+    void newGame();
+
+    /**
+     * @brief 這一步從收到指令起最多可以用的毫秒數（已扣除安全邊際）
+     */
+    int moveBudget() const;
+
+    /**
+     * @brief 記錄一步實際用掉的毫秒數（從收到指令到輸出著手）
+     */
+    void moveFinished(int elapsed);
+
+   private:
+    int turnLimit = DEFAULT_TURN_MS;
+    int matchLimit = 0;
+    int timeLeft = -1;  ///< 管理程式最近一次告知的剩餘時間，-1 表示沒有告知
+    int used = 0;       ///< 這盤棋自己累計的用時
+    int moves = 0;      ///< 這盤棋自己已經下的步數
+
+    static int margin(int limit) { return MIN_MARGIN_MS + limit / 100 * MARGIN_PERCENT; }
+};
+
+#endif  // TIMEMANAGER_HPP
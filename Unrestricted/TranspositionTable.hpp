@@ -0,0 +1,116 @@
+#pragma once
+#include <stdint.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+
+#include "Node.hpp"
+
+/**
+ * @brief 以 Zobrist 雜湊索引已拓展節點的並行置換表
+ *
+ * 不同著手順序到達的同一局面只拓展一次：後來的節點直接共用先拓展者的子節點區塊，
+ * 整棵搜尋樹因此成為 DAG，子樹的統計與節點都只存一份。
+ *
+ * - 容量固定（2 的冪次），建構後不再成長，記憶體上限明確
+ * - 每個 bucket 有 BUCKET_SIZE 個 entry；bucket 滿了就取代訪問次數最少的節點
+ * - 雜湊碰撞：命中後一律比對兩個位棋盤，不同局面視為未命中
+ * - 所有操作皆為 lock-free；寫入中途被讀到的不一致 entry 也會在比對棋盤時被排除
+ */
+template <int N>
+class TranspositionTable {
+   private:
+    static constexpr size_t BUCKET_SIZE = 4;
+
+    struct Entry {
+        std::atomic<uint64_t> key{0};
+        std::atomic<Node<N>*> node{nullptr};
+    };
+
+    std::unique_ptr<Entry[]> entries;
+    size_t mask;  ///< bucket 數量減一；容量為 0 時表示停用
+
+    static bool samePosition(const Node<N>* a, const Node<N>* b) {
+        return memcmp(a->boardBlack, b->boardBlack, sizeof(a->boardBlack)) == 0 &&
+               memcmp(a->boardWhite, b->boardWhite, sizeof(a->boardWhite)) == 0;
+    }
+
+    Entry* bucket(uint64_t hash) const { return &entries[(hash & mask) * BUCKET_SIZE]; }
+
+   public:
+    /**
+     * @param capacity entry 數量，會向下取到 BUCKET_SIZE 的 2 的冪次倍；0 表示停用
+     */
+    explicit TranspositionTable(size_t capacity = 0) { resize(capacity); }
+
+    void resize(size_t capacity) {
+        size_t buckets = 1;
+        while (buckets * 2 * BUCKET_SIZE <= capacity) buckets *= 2;
+        if (capacity < BUCKET_SIZE) {
+            entries.reset();
+            mask = 0;
+            return;
+        }
+        entries.reset(new Entry[buckets * BUCKET_SIZE]);
+        mask = buckets - 1;
+    }
+
+    bool enabled() const { return entries != nullptr; }
+
+    /// @brief 置換表佔用的位元組數
+    size_t memoryUsage() const { return enabled() ? (mask + 1) * BUCKET_SIZE * sizeof(Entry) : 0; }
+
+    void clear() {
+        if (!enabled()) return;
+        for (size_t i = 0; i < (mask + 1) * BUCKET_SIZE; i++) {
+            entries[i].key.store(0, std::memory_order_relaxed);
+            entries[i].node.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief 找出與 position 相同局面且已拓展完成的節點
+     *
+     * @return Node<N>* 可共用子節點區塊的節點；找不到時為 nullptr
+     */
+    Node<N>* lookup(const Node<N>* position) const {
+        if (!enabled() || position->hash == 0) return nullptr;
+        Entry* slots = bucket(position->hash);
+        for (size_t i = 0; i < BUCKET_SIZE; i++) {
+            if (slots[i].key.load(std::memory_order_acquire) != position->hash) continue;
+            Node<N>* node = slots[i].node.load(std::memory_order_acquire);
+            if (node != nullptr && node != position && node->childCount.load(std::memory_order_acquire) > 0 &&
+                samePosition(node, position)) {
+                return node;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief 記錄一個已拓展完成的節點，bucket 已滿時取代訪問次數最少的 entry
+     */
+    void insert(Node<N>* node) {
+        if (!enabled() || node->hash == 0) return;
+        Entry* slots = bucket(node->hash);
+        Entry* victim = &slots[0];
+        int fewestVisits = INT32_MAX;
+        for (size_t i = 0; i < BUCKET_SIZE; i++) {
+            uint64_t key = slots[i].key.load(std::memory_order_relaxed);
+            if (key == 0 && slots[i].key.compare_exchange_strong(key, node->hash, std::memory_order_acq_rel)) {
+                slots[i].node.store(node, std::memory_order_release);
+                return;
+            }
+            Node<N>* occupant = slots[i].node.load(std::memory_order_relaxed);
+            int visits = occupant ? occupant->visits.load(std::memory_order_relaxed) : 0;
+            if (visits < fewestVisits) {
+                fewestVisits = visits;
+                victim = &slots[i];
+            }
+        }
+        victim->node.store(node, std::memory_order_release);
+        victim->key.store(node->hash, std::memory_order_release);
+    }
+};
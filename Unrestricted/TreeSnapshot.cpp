@@ -0,0 +1,174 @@
+#include "TreeSnapshot.hpp"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Bitboard.hpp"
+#include "Zobrist.hpp"
+
+template <int N>
+bool TreeSnapshot<N>::open(const char* path) {
+    close();
+    if (!file.open(path)) {
+        return false;
+    }
+    // 只檢查檔頭與檔案長度，不讀取任何節點
+    const SnapshotHeader* header = reinterpret_cast<const SnapshotHeader*>(file.data());
+    if (file.size() < sizeof(SnapshotHeader) || header->magic != MAGIC || header->version != VERSION ||
+        header->boardSize != N || header->nodeCount == 0 ||
+        file.size() != sizeof(SnapshotHeader) + header->nodeCount * sizeof(SnapshotNode) +
+                           header->indexCount * sizeof(IndexEntry)) {
+        close();
+        return false;
+    }
+    nodes = reinterpret_cast<const SnapshotNode*>(file.data() + sizeof(SnapshotHeader));
+    nodeCount = header->nodeCount;
+    index = reinterpret_cast<const IndexEntry*>(nodes + nodeCount);
+    indexCount = header->indexCount;
+    return true;
+}
+
+template <int N>
+void TreeSnapshot<N>::close() {
+    file.close();
+    nodes = nullptr;
+    index = nullptr;
+    nodeCount = 0;
+    indexCount = 0;
+}
+
+template <int N>
+const typename TreeSnapshot<N>::SnapshotNode* TreeSnapshot<N>::find(uint64_t hash) const {
+    if (!isOpen()) {
+        return nullptr;
+    }
+    const IndexEntry* entry =
+        std::lower_bound(index, index + indexCount, hash, [](const IndexEntry& e, uint64_t h) { return e.hash < h; });
+    if (entry == index + indexCount || entry->hash != hash || entry->node >= nodeCount) {
+        return nullptr;
+    }
+    const SnapshotNode* node = nodes + entry->node;
+    // 損壞的檔案不能讓子節點區塊超出節點陣列
+    if (static_cast<size_t>(node->firstChild) + node->childCount > nodeCount) {
+        return nullptr;
+    }
+    return node;
+}
+
+template <int N>
+bool TreeSnapshot<N>::save(const char* path, const Node<N>* root, const TreeSnapshot* previous) {
+    if (previous != nullptr && !previous->isOpen()) {
+        previous = nullptr;
+    }
+    auto record = [](const Node<N>* node) {
+        SnapshotNode snapshot = {};
+        snapshot.wins = node->wins.load(std::memory_order_relaxed);
+        snapshot.visits = node->visits.load(std::memory_order_relaxed);
+        snapshot.move = node->lastMove.x < 0 ? NO_MOVE : static_cast<uint16_t>(Board<N>::index(node->lastMove));
+        snapshot.proven = node->proven.load(std::memory_order_relaxed);
+        return snapshot;
+    };
+    // 每個輸出節點的來源：樹上的節點，或是（樹上沒有拓展時）舊快照中的節點
+    struct Source {
+        const Node<N>* live;
+        const SnapshotNode* saved;
+        uint64_t hash;
+        bool isBlackTurn;
+    };
+    std::vector<SnapshotNode> nodes = {record(root)};
+    std::vector<Source> order = {{root, nullptr, root->hash, root->isBlackTurn}};  // order[i] 是 nodes[i] 的來源
+    std::vector<IndexEntry> index;
+    // 已寫入的子節點區塊 → (第一個子節點的索引, 節點數)；共用區塊的每個父節點都寫入同一組值
+    std::unordered_map<const void*, std::pair<uint32_t, int>> blocks;
+    for (size_t i = 0; i < order.size(); i++) {
+        Source source = order[i];
+        if (source.live != nullptr && source.live->childCount.load(std::memory_order_acquire) == 0 &&
+            previous != nullptr) {
+            // 這次沒有走到的子樹沿用舊快照，暖啟動後再存檔不會遺失上一次的搜尋結果
+            source.saved = previous->find(source.hash);
+            source.live = nullptr;
+        }
+        // 置換表共用的區塊中各父節點的 childCount 可能不同，一律以區塊中已建立的節點數為準
+        int childCount = source.live != nullptr ? source.live->builtChildren()
+                                                : (source.saved != nullptr ? source.saved->childCount : 0);
+        if (childCount == 0) {
+            continue;
+        }
+        const void* key = source.live != nullptr ? static_cast<const void*>(source.live->children)
+                                                 : static_cast<const void*>(previous->children(source.saved));
+        auto [block, inserted] = blocks.try_emplace(key, static_cast<uint32_t>(nodes.size()), childCount);
+        if (inserted) {
+            if (source.live != nullptr) {
+                std::vector<const Node<N>*> children;
+                for (int j = 0; j < childCount; j++) {
+                    children.push_back(&source.live->children[j]);
+                }
+                // 拓展產生的區塊依先驗分數排列，檔案中一律改依格子索引排列，與拓展順序無關
+                std::sort(children.begin(), children.end(), [](const Node<N>* a, const Node<N>* b) {
+                    return Board<N>::index(a->lastMove) < Board<N>::index(b->lastMove);
+                });
+                for (const Node<N>* child : children) {
+                    order.push_back({child, nullptr, child->hash, child->isBlackTurn});
+                    nodes.push_back(record(child));
+                }
+            } else {
+                // 舊快照的節點沒有存雜湊，由父節點的雜湊與著手推算
+                const SnapshotNode* children = previous->children(source.saved);
+                for (int j = 0; j < childCount; j++) {
+                    if (children[j].move >= Board<N>::CELLS) {
+                        return false;
+                    }
+                    uint64_t hash = source.hash ^ zobristKey<N>(children[j].move, !source.isBlackTurn);
+                    order.push_back({nullptr, &children[j], hash, !source.isBlackTurn});
+                    nodes.push_back(children[j]);
+                    nodes.back().firstChild = 0;
+                    nodes.back().childCount = 0;
+                }
+            }
+            if (nodes.size() > UINT32_MAX) {
+                return false;
+            }
+        }
+        nodes[i].firstChild = block->second.first;
+        nodes[i].childCount = static_cast<uint16_t>(block->second.second);
+        index.push_back({source.hash, static_cast<uint32_t>(i), 0});
+    }
+    std::sort(index.begin(), index.end(), [&](const IndexEntry& a, const IndexEntry& b) {
+        return a.hash != b.hash ? a.hash < b.hash : nodes[a.node].visits > nodes[b.node].visits;
+    });
+    index.erase(std::unique(index.begin(), index.end(),
+                            [](const IndexEntry& a, const IndexEntry& b) { return a.hash == b.hash; }),
+                index.end());
+
+    // 先寫到暫存檔再換名，previous 可以是同一個檔案，中途失敗也不會破壞原本的快照
+    std::string temporary = std::string(path) + ".tmp";
+    FILE* out = fopen(temporary.c_str(), "wb");
+    if (out == nullptr) {
+        return false;
+    }
+    SnapshotHeader header = {MAGIC, VERSION, static_cast<uint32_t>(N), nodes.size(), index.size()};
+    bool ok = fwrite(&header, sizeof(header), 1, out) == 1 &&
+              fwrite(nodes.data(), sizeof(SnapshotNode), nodes.size(), out) == nodes.size() &&
+              fwrite(index.data(), sizeof(IndexEntry), index.size(), out) == index.size();
+    ok = fclose(out) == 0 && ok;
+#ifdef _WIN32
+    // Windows 的 rename 不會覆寫既有檔案
+    ok = ok && (std::remove(path) == 0 || errno == ENOENT);
+#endif
+    ok = ok && std::rename(temporary.c_str(), path) == 0;
+    if (!ok) {
+        std::remove(temporary.c_str());
+    }
+    return ok;
+}
+
+template class TreeSnapshot<9>;
+template class TreeSnapshot<15>;
+template class TreeSnapshot<19>;
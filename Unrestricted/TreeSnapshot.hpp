@@ -0,0 +1,94 @@
+#ifndef TREESNAPSHOT_HPP
+#define TREESNAPSHOT_HPP
+
+#include <stdint.h>
+
+#include "MappedFile.hpp"
+#include "Node.hpp"
+
+/**
+ * @brief 搜尋樹的快照檔，讓下一次執行可以接著上一次的統計繼續搜尋
+ *
+ * 檔案格式（本機位元組序）：32 byte 的 SnapshotHeader，之後是 nodeCount 個 SnapshotNode，
+ * 最後是 indexCount 個依雜湊由小到大排序的 IndexEntry。
+ * - 節點以廣度優先順序存放，每個子節點區塊保持連續，父節點以陣列索引 firstChild 指向區塊，
+ *   檔案中沒有任何指標，映射到任何位址都能直接使用
+ * - 置換表共用的子節點區塊只存一份，DAG 的結構原樣保留
+ * - 索引只收錄已拓展的節點，同一局面只保留訪問次數最多的一筆
+ *
+ * 開啟時只檢查檔頭與長度，不解析也不建立任何節點；MCTS 拓展節點時才以局面雜湊查詢快照，
+ * 把對應的統計帶入新建的子節點（見 MCTS::setSnapshot），實際碰到的節點才會被讀取。
+ *
+ * 樣板只在 TreeSnapshot.cpp 中對支援的棋盤大小（9、15、19）明確實例化。
+ */
+template <int N>
+class TreeSnapshot {
+   public:
+    static constexpr uint64_t MAGIC = 0x31454552544B4D47ULL;  ///< "GMKTREE1"
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint16_t NO_MOVE = 0xFFFF;  ///< 空棋盤根節點的 move
+
+    struct SnapshotHeader {
+        uint64_t magic;
+        uint32_t version;
+        uint32_t boardSize;
+        uint64_t nodeCount;
+        uint64_t indexCount;
+    };
+
+    struct SnapshotNode {
+        double wins;
+        int32_t visits;
+        uint32_t firstChild;  ///< 子節點區塊第一個節點的索引，沒有子節點時為 0
+        uint16_t childCount;
+        uint16_t move;  ///< 落下的格子索引，區塊內由小到大排列
+        int8_t proven;  ///< proofStatus
+        uint8_t reserved[3];
+    };
+
+    struct IndexEntry {
+        uint64_t hash;
+        uint32_t node;
+        uint32_t reserved;
+    };
+    static_assert(sizeof(SnapshotHeader) == 32 && sizeof(SnapshotNode) == 24 && sizeof(IndexEntry) == 16,
+                  "檔案格式不能有額外的 padding");
+
+    /**
+     * @brief 映射快照檔，檔案不存在、棋盤大小不符或格式錯誤時回傳 false
+     */
+    bool open(const char* path);
+    /// @brief 解除映射
+    void close();
+    bool isOpen() const { return nodes != nullptr; }
+    size_t size() const { return nodeCount; }
+
+    /**
+     * @brief 查詢局面雜湊為 hash 的已拓展節點
+     *
+     * @return const SnapshotNode* 快照中的節點；沒有收錄時為 nullptr
+     */
+    const SnapshotNode* find(uint64_t hash) const;
+    /// @brief 節點的子節點區塊
+    const SnapshotNode* children(const SnapshotNode* node) const { return nodes + node->firstChild; }
+
+    /**
+     * @brief 把 root 底下的整棵子樹寫成快照檔，寫入期間不可有其他執行緒在搜尋這棵樹
+     *
+     * @param previous 暖啟動時使用的舊快照（POSIX 上可以是同一個檔案）：樹上沒有拓展、但舊快照收錄了的子樹會原樣保留
+     */
+    static bool save(const char* path, const Node<N>* root, const TreeSnapshot* previous = nullptr);
+
+   private:
+    MappedFile file;
+    const SnapshotNode* nodes = nullptr;
+    const IndexEntry* index = nullptr;
+    size_t nodeCount = 0;
+    size_t indexCount = 0;
+};
+
+extern template class TreeSnapshot<9>;
+extern template class TreeSnapshot<15>;
+extern template class TreeSnapshot<19>;
+
+#endif  // TREESNAPSHOT_HPP
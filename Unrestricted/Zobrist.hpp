@@ -0,0 +1,36 @@
+#ifndef ZOBRIST_HPP
+#define ZOBRIST_HPP
+
+#include <stdint.h>
+
+#include <array>
+
+#include "Bitboard.hpp"
+#include "Random.hpp"
+
+/**
+ * @brief Zobrist 雜湊：每個 (顏色, 格子) 對應一個固定的 64 bit 亂數，局面的雜湊是所有棋子亂數的 XOR
+ *
+ * 落子時只需要 XOR 一個值即可增量更新；輪到誰下可由棋子數推得，所以不另外編碼。
+ * 亂數在編譯期以 splitmix64 產生，每次執行都相同。
+ */
+template <int N>
+constexpr std::array<std::array<uint64_t, N * N>, 2> createZobristTable() {
+    std::array<std::array<uint64_t, N * N>, 2> table{};
+    uint64_t state = 0x5A0B2157ULL;
+    for (int color = 0; color < 2; color++) {
+        for (int pos = 0; pos < N * N; pos++) {
+            table[color][pos] = splitMix64(state);
+        }
+    }
+    return table;
+}
+
+/// N x N 棋盤的 [顏色 (0 = 黑, 1 = 白)][格子]
+template <int N>
+constexpr auto ZOBRIST_TABLE = createZobristTable<N>();
+
+template <int N>
+inline uint64_t zobristKey(int pos, bool isBlack) { return ZOBRIST_TABLE<N>[isBlack ? 0 : 1][pos]; }
+
+#endif  // ZOBRIST_HPP
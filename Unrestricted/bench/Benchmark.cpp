@@ -0,0 +1,334 @@
+#include <stdint.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Bitboard.hpp"
+#include "Game.hpp"
+#include "MCTS.hpp"
+#include "Node.hpp"
+#include "NodeArena.hpp"
+#include "Random.hpp"
+
+/**
+ * @brief 直接呼叫 MCTS 內部步驟的入口（MCTS 的 friend）
+ */
+template <int N>
+struct MCTSBenchmark {
+    static constexpr int MAX_PATH = MCTS<N>::MAX_PATH;
+    static Node<N>* expansion(MCTS<N>& ai, Node<N>* node, NodeArena<N>& arena) { return ai.expansion(node, arena); }
+    static int playout(MCTS<N>& ai, Node<N>* node, PlayoutRng& rng) { return ai.playout(node, rng); }
+    static int runPlayouts(MCTS<N>& ai, Node<N>* node, uint64_t iteration, int count) {
+        return ai.runPlayouts(node, iteration, 0, count);
+    }
+    static int selection(MCTS<N>& ai, Node<N>* root, Node<N>** path) { return ai.selection(root, path); }
+    static void backpropagation(MCTS<N>& ai, Node<N>** path, int length, bool isXTurn, double win) {
+        ai.backpropagation(path, length, isXTurn, win);
+    }
+};
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr uint32_t CORPUS_SEED = 20240601;  ///< 固定種子，讓每次建置量到的是同一組局面
+constexpr int POSITIONS_PER_PHASE = 4;
+constexpr int TREE_ITERATIONS = 2000;  ///< selection/backpropagation 量測前先長出的樹大小
+
+/// @brief 語料庫的一個階段：從空棋盤隨機下到 stones 顆棋子（不產生連五）
+struct Phase {
+    const char* name;
+    int stones;
+};
+constexpr Phase PHASES[] = {{"opening", 6}, {"middlegame", 30}, {"endgame", 80}};
+
+/// @brief 語料庫中的一個局面，各自擁有一個 MCTS 以保存它的搜尋樹
+template <int N>
+struct CorpusEntry {
+    std::unique_ptr<MCTS<N>> ai;
+    Node<N>* root;
+    Node<N> pristine;  ///< 尚未拓展的根節點副本，用於量測 expansion
+};
+
+struct Options {
+    std::string output = "benchmark.csv";
+    int samples = 50;
+    int warmup = 5;
+};
+
+struct Statistics {
+    double median;
+    double p10;
+    double p90;
+    double p99;
+    double min;
+};
+
+volatile uint64_t sink;  ///< 保留 kernel 的結果，避免被編譯器整段刪掉
+
+/**
+ * @brief 從空棋盤開始，每步在相鄰空位中隨機落子，跳過會連成五顆的位置
+ */
+template <int N>
+Node<N>* buildPosition(MCTS<N>& ai, int stones, std::mt19937& rng) {
+    Node<N>* node = ai.createRoot();
+    node = ai.advanceRoot(node, {N / 2, N / 2});
+    for (int placed = 1; placed < stones; placed++) {
+        uint64_t candidates[Board<N>::BITBOARD_COUNT];
+        Board<N>::emptyNeighbours(node->boardBlack, node->boardWhite, candidates);
+        std::vector<int> moves;
+        Board<N>::forEachBit(candidates, [&](int pos) { moves.push_back(pos); });
+        std::shuffle(moves.begin(), moves.end(), rng);
+        for (int pos : moves) {
+            Node<N> child(Board<N>::LOOKUP_TABLE[pos], node);
+            if (!child.isWin) {
+                node = ai.advanceRoot(node, Board<N>::LOOKUP_TABLE[pos]);
+                break;
+            }
+        }
+    }
+    return node;
+}
+
+template <int N>
+std::vector<CorpusEntry<N>> buildCorpus(const Phase& phase, std::mt19937& rng) {
+    std::vector<CorpusEntry<N>> corpus(POSITIONS_PER_PHASE);
+    for (CorpusEntry<N>& entry : corpus) {
+        entry.ai = std::make_unique<MCTS<N>>(1, 1, searchMode::LEAF_PARALLEL);
+        entry.ai->setSeed(CORPUS_SEED);
+        entry.root = buildPosition(*entry.ai, phase.stones, rng);
+        new (&entry.pristine) Node<N>(*entry.root);
+        entry.pristine.parent = nullptr;
+        entry.pristine.children = nullptr;
+        entry.pristine.childCount = 0;
+        entry.pristine.expanding = false;
+    }
+    return corpus;
+}
+
+double percentile(const std::vector<double>& sorted, double q) {
+    return sorted[static_cast<size_t>(std::lround(q * (sorted.size() - 1)))];
+}
+
+Statistics summarize(std::vector<double> samples) {
+    std::sort(samples.begin(), samples.end());
+    return {percentile(samples, 0.5), percentile(samples, 0.1), percentile(samples, 0.9), percentile(samples, 0.99),
+            samples.front()};
+}
+
+/**
+ * @brief 先跑 warmup 次不計時，再量 samples 次，每次呼叫 kernel(sample) 執行 opsPerSample 個操作
+ *
+ * @return std::vector<double> 每個 sample 的平均單次操作耗時（奈秒）
+ */
+template <class Kernel>
+std::vector<double> measure(const Options& options, int opsPerSample, Kernel&& kernel) {
+    for (int i = 0; i < options.warmup; i++) {
+        kernel(i);
+    }
+    std::vector<double> samples;
+    samples.reserve(options.samples);
+    for (int i = 0; i < options.samples; i++) {
+        auto start = Clock::now();
+        kernel(options.warmup + i);
+        auto end = Clock::now();
+        samples.push_back(std::chrono::duration<double, std::nano>(end - start).count() / opsPerSample);
+    }
+    return samples;
+}
+
+/// @brief 候選落子已經下在棋盤上的狀態，只量 checkWin 本身
+template <int N>
+struct CheckWinCase {
+    uint64_t boardBlack[Board<N>::BITBOARD_COUNT];
+    uint64_t boardWhite[Board<N>::BITBOARD_COUNT];
+    Position move;
+    bool isBlackTurn;
+};
+
+template <int N>
+std::vector<CheckWinCase<N>> buildCheckWinCases(const std::vector<CorpusEntry<N>>& corpus) {
+    std::vector<CheckWinCase<N>> cases;
+    for (const CorpusEntry<N>& entry : corpus) {
+        uint64_t candidates[Board<N>::BITBOARD_COUNT];
+        Board<N>::emptyNeighbours(entry.root->boardBlack, entry.root->boardWhite, candidates);
+        Board<N>::forEachBit(candidates, [&](int pos) {
+            CheckWinCase<N> c;
+            memcpy(c.boardBlack, entry.root->boardBlack, sizeof(c.boardBlack));
+            memcpy(c.boardWhite, entry.root->boardWhite, sizeof(c.boardWhite));
+            c.move = Board<N>::LOOKUP_TABLE[pos];
+            c.isBlackTurn = !entry.root->isBlackTurn;
+            setBit(c.isBlackTurn ? c.boardBlack : c.boardWhite, pos);
+            cases.push_back(c);
+        });
+    }
+    return cases;
+}
+
+struct Report {
+    std::ofstream csv;
+    int boardSize = 0;  ///< 目前量測的棋盤大小
+
+    void add(const char* kernel, const char* phase, const Options& options, int opsPerSample,
+             const std::vector<double>& samples) {
+        Statistics s = summarize(samples);
+        csv << boardSize << "," << kernel << "," << phase << "," << options.samples << "," << opsPerSample << ","
+            << s.median << "," << s.p10 << "," << s.p90 << "," << s.p99 << "," << s.min << std::endl;
+        std::cout << std::right << std::setw(2) << boardSize << "x" << std::left << std::setw(3) << boardSize
+                  << std::setw(22) << kernel << std::setw(12) << phase << std::right << std::fixed
+                  << std::setprecision(1) << " median " << std::setw(10) << s.median << " ns  p10 " << std::setw(10)
+                  << s.p10 << "  p90 " << std::setw(10) << s.p90 << "  p99 " << std::setw(10) << s.p99 << std::endl;
+    }
+};
+
+template <int N>
+void benchmarkPhase(const Phase& phase, const Options& options, std::mt19937& rng, Report& report) {
+    std::vector<CorpusEntry<N>> corpus = buildCorpus<N>(phase, rng);
+
+    // Game::checkWin：語料庫每個局面的每個候選落子
+    std::vector<CheckWinCase<N>> cases = buildCheckWinCases(corpus);
+    const int checkWinRounds = 32;
+    report.add("checkWin", phase.name, options, checkWinRounds * static_cast<int>(cases.size()),
+               measure(options, checkWinRounds * static_cast<int>(cases.size()), [&](int) {
+                   uint64_t wins = 0;
+                   for (int round = 0; round < checkWinRounds; round++) {
+                       for (CheckWinCase<N>& c : cases) {
+                           wins += Game<N>::checkWin(c.move, c.boardBlack, c.boardWhite, c.isBlackTurn);
+                       }
+                   }
+                   sink = wins;
+               }));
+
+    // MCTS::expansion：每次從未拓展的根節點副本重新拓展，子節點放在可整批回收的 arena；
+    // 置換表關閉，量到的是真正建立子節點的成本
+    MCTS<N> expander(1, 1, searchMode::LEAF_PARALLEL);
+    expander.setTranspositionTableSize(0);
+    NodeArena<N> arena;
+    const int expansionRounds = 16;
+    const int expansionOps = expansionRounds * POSITIONS_PER_PHASE;
+    report.add("expansion", phase.name, options, expansionOps, measure(options, expansionOps, [&](int) {
+                   uint64_t children = 0;
+                   for (int round = 0; round < expansionRounds; round++) {
+                       for (CorpusEntry<N>& entry : corpus) {
+                           Node<N> scratch(entry.pristine);
+                           MCTSBenchmark<N>::expansion(expander, &scratch, arena);
+                           children += scratch.childCount;
+                           arena.reset();
+                       }
+                   }
+                   sink = children;
+               }));
+
+    // MCTS::playout：兩種走子策略，各自以固定種子的亂數流
+    const int playoutRounds = 8;
+    const int playoutOps = playoutRounds * POSITIONS_PER_PHASE;
+    for (playoutPolicy policy : {playoutPolicy::RANDOM_PLAYOUT, playoutPolicy::PATTERN_PLAYOUT}) {
+        PlayoutRng playoutRng(CORPUS_SEED, 0, 0);
+        for (CorpusEntry<N>& entry : corpus) {
+            entry.ai->setPlayoutPolicy(policy);
+        }
+        const char* name = policy == playoutPolicy::RANDOM_PLAYOUT ? "playout-random" : "playout-pattern";
+        report.add(name, phase.name, options, playoutOps, measure(options, playoutOps, [&](int) {
+                       uint64_t results = 0;
+                       for (int round = 0; round < playoutRounds; round++) {
+                           for (CorpusEntry<N>& entry : corpus) {
+                               results += MCTSBenchmark<N>::playout(*entry.ai, entry.root, playoutRng);
+                           }
+                       }
+                       sink = results;
+                   }));
+    }
+
+    // 批次隨機 playout（CPU 不支援 SIMD kernel 時量到的是逐局純量版本）
+    const int batchedOps = playoutRounds * POSITIONS_PER_PHASE * PLAYOUT_BATCH;
+    for (CorpusEntry<N>& entry : corpus) {
+        entry.ai->setPlayoutPolicy(playoutPolicy::RANDOM_PLAYOUT);
+    }
+    report.add("playout-batched", phase.name, options, batchedOps, measure(options, batchedOps, [&](int sample) {
+                   uint64_t results = 0;
+                   for (int round = 0; round < playoutRounds; round++) {
+                       for (CorpusEntry<N>& entry : corpus) {
+                           results += MCTSBenchmark<N>::runPlayouts(*entry.ai, entry.root,
+                                                                    sample * playoutRounds + round, PLAYOUT_BATCH);
+                       }
+                   }
+                   sink = results;
+               }));
+
+    // selection + backpropagation：先讓每個局面長出一棵樹，再量從根走到葉並回傳的成本
+    for (CorpusEntry<N>& entry : corpus) {
+        entry.ai->run(entry.root, TREE_ITERATIONS);
+    }
+    const int descentRounds = 64;
+    const int descentOps = descentRounds * POSITIONS_PER_PHASE;
+    report.add("selection+backprop", phase.name, options, descentOps, measure(options, descentOps, [&](int) {
+                   uint64_t depth = 0;
+                   Node<N>* path[MCTSBenchmark<N>::MAX_PATH];
+                   for (int round = 0; round < descentRounds; round++) {
+                       for (CorpusEntry<N>& entry : corpus) {
+                           int length = MCTSBenchmark<N>::selection(*entry.ai, entry.root, path);
+                           MCTSBenchmark<N>::backpropagation(*entry.ai, path, length, path[length - 1]->isBlackTurn,
+                                                             0.5);
+                           depth += length;
+                       }
+                   }
+                   sink = depth;
+               }));
+
+    // 完整的搜尋 iteration（選擇、拓展、playout、回傳），作為上面各 kernel 的總和對照
+    const int searchIterations = 32;
+    const int searchOps = searchIterations * POSITIONS_PER_PHASE;
+    report.add("search-iteration", phase.name, options, searchOps, measure(options, searchOps, [&](int) {
+                   for (CorpusEntry<N>& entry : corpus) {
+                       entry.ai->run(entry.root, searchIterations);
+                   }
+               }));
+}
+
+/// @brief N x N 棋盤的所有階段
+template <int N>
+void benchmarkBoard(const Options& options, std::mt19937& rng, Report& report) {
+    report.boardSize = N;
+    for (const Phase& phase : PHASES) {
+        benchmarkPhase<N>(phase, options, rng, report);
+    }
+}
+
+}  // namespace
+
+/**
+ * @brief 引擎熱點 kernel 的基準測試
+ *
+ * 用法：Benchmark [輸出 CSV 路徑] [sample 數] [warm-up 數]
+ * 15x15 與 19x19 兩種棋盤各自以固定種子產生開局、中盤、殘局各數個局面，每個 kernel 先暖身再量測，
+ * 輸出每次操作耗時的中位數與百分位數，CSV 可直接在不同建置之間比較。
+ */
+int main(int argc, char** argv) {
+    Options options;
+    if (argc > 1) options.output = argv[1];
+    if (argc > 2) options.samples = std::max(1, atoi(argv[2]));
+    if (argc > 3) options.warmup = std::max(0, atoi(argv[3]));
+
+    Report report;
+    report.csv.open(options.output);
+    if (!report.csv.is_open()) {
+        std::cerr << "Error: Unable to open output file!" << std::endl;
+        return 1;
+    }
+    report.csv << "Board,Kernel,Phase,Samples,OpsPerSample,MedianNs,P10Ns,P90Ns,P99Ns,MinNs" << std::endl;
+
+    std::mt19937 rng(CORPUS_SEED);
+    benchmarkBoard<15>(options, rng, report);
+    benchmarkBoard<19>(options, rng, report);
+    return 0;
+}
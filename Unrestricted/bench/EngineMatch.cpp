@@ -0,0 +1,127 @@
+#include <stdint.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "AlphaBeta.hpp"
+#include "BatchPlayout.hpp"
+#include "Bitboard.hpp"
+#include "Game.hpp"
+#include "MCTS.hpp"
+#include "Node.hpp"
+
+namespace {
+
+constexpr int N = DEFAULT_BOARD_SIZE;
+constexpr uint32_t OPENING_SEED = 20240601;      ///< 固定種子，讓每次建置比較的是同一組開局
+constexpr int OPENING_STONES = 3;                ///< 開局在天元附近隨機放的棋子數
+constexpr int PLAYOUTS_PER_LEAF = PLAYOUT_BATCH;  ///< MCTS 每個葉節點的 playout 數，剛好是一個批次
+
+struct Options {
+    std::string output = "engine_match.csv";
+    int openings = 10;  ///< 每個開局雙方各執黑一次
+    int timeLimit = 500;
+    int threads = 1;  ///< MCTS 的執行緒數，預設 1 讓兩個引擎用同樣的 CPU 時間
+};
+
+/// @brief 一盤棋的結果：1 = alpha-beta 勝，-1 = MCTS 勝，0 = 平手
+struct MatchResult {
+    int outcome;
+    int moves;
+    double averageDepth;       ///< alpha-beta 每步完整搜完的平均深度
+    double averageIterations;  ///< MCTS 每步的平均 iteration 數
+};
+
+std::vector<Position> randomOpening(std::mt19937& rng) {
+    std::vector<Position> opening;
+    while (static_cast<int>(opening.size()) < OPENING_STONES) {
+        Position position = {N / 2 - 2 + static_cast<int>(rng() % 5), N / 2 - 2 + static_cast<int>(rng() % 5)};
+        bool taken = false;
+        for (const Position& stone : opening) {
+            taken |= stone.x == position.x && stone.y == position.y;
+        }
+        if (!taken) opening.push_back(position);
+    }
+    return opening;
+}
+
+MatchResult playMatch(const std::vector<Position>& opening, bool alphaBetaBlack, const Options& options) {
+    MCTS<N> mcts(PLAYOUTS_PER_LEAF, options.threads, searchMode::TREE_PARALLEL);
+    AlphaBeta<N> alphaBeta;
+    Node<N>* node = mcts.createRoot();
+    int moves = 0;
+    for (const Position& stone : opening) {
+        node = mcts.advanceRoot(node, stone);
+        moves++;
+    }
+    long long depthSum = 0, iterationSum = 0;
+    int alphaBetaMoves = 0, mctsMoves = 0;
+    while (!node->isWin && moves < Board<N>::CELLS) {
+        bool blackToMove = !node->isBlackTurn;
+        Position move;
+        if (blackToMove == alphaBetaBlack) {
+            move = alphaBeta.search(node, options.timeLimit);
+            depthSum += alphaBeta.completedDepth();
+            alphaBetaMoves++;
+        } else {
+            iterationSum += mcts.runFor(node, options.timeLimit);
+            move = mcts.bestChild(node)->lastMove;
+            mctsMoves++;
+        }
+        node = mcts.advanceRoot(node, move);
+        moves++;
+    }
+    int outcome = 0;
+    if (node->isWin) {
+        outcome = node->isBlackTurn == alphaBetaBlack ? 1 : -1;
+    }
+    return {outcome, moves, alphaBetaMoves ? static_cast<double>(depthSum) / alphaBetaMoves : 0.0,
+            mctsMoves ? static_cast<double>(iterationSum) / mctsMoves : 0.0};
+}
+
+}  // namespace
+
+/**
+ * @brief 以相同的每步時間讓 alpha-beta 與 MCTS 對弈
+ *
+ * 用法：EngineMatch [輸出 CSV 路徑] [開局數] [每步毫秒] [MCTS 執行緒數]
+ * 開局以固定種子在天元附近隨機放幾顆棋子，每個開局雙方各執黑一次，兩個引擎都不經過連續威脅搜尋。
+ */
+int main(int argc, char** argv) {
+    Options options;
+    if (argc > 1) options.output = argv[1];
+    if (argc > 2) options.openings = std::max(1, atoi(argv[2]));
+    if (argc > 3) options.timeLimit = std::max(1, atoi(argv[3]));
+    if (argc > 4) options.threads = std::max(1, atoi(argv[4]));
+
+    std::ofstream csv(options.output);
+    if (!csv.is_open()) {
+        std::cerr << "Error: Unable to open output file!" << std::endl;
+        return 1;
+    }
+    csv << "Opening,AlphaBetaColor,Winner,Moves,TimeLimitMs,AlphaBetaAverageDepth,MCTSAverageIterations" << std::endl;
+
+    std::mt19937 rng(OPENING_SEED);
+    int wins = 0, losses = 0, draws = 0;
+    for (int i = 0; i < options.openings; i++) {
+        std::vector<Position> opening = randomOpening(rng);
+        for (bool alphaBetaBlack : {true, false}) {
+            MatchResult result = playMatch(opening, alphaBetaBlack, options);
+            const char* winner = result.outcome > 0 ? "AlphaBeta" : result.outcome < 0 ? "MCTS" : "Draw";
+            wins += result.outcome > 0;
+            losses += result.outcome < 0;
+            draws += result.outcome == 0;
+            csv << i << "," << (alphaBetaBlack ? "Black" : "White") << "," << winner << "," << result.moves << ","
+                << options.timeLimit << "," << result.averageDepth << "," << result.averageIterations << std::endl;
+            std::cout << "opening " << i << ", alpha-beta " << (alphaBetaBlack ? "black" : "white") << ": " << winner
+                      << " after " << result.moves << " moves" << std::endl;
+        }
+    }
+    std::cout << "alpha-beta vs MCTS: " << wins << " wins, " << losses << " losses, " << draws << " draws" << std::endl;
+    return 0;
+}
@@ -15,7 +15,7 @@ int main() {
     cout << "Input how many game you want to play." << endl;
     cin >> gameTimes;
     for (int i = 0; i < gameTimes; i++) {
-        Game::startGame();
+        Game<DEFAULT_BOARD_SIZE>::startGame();  // 19 路棋盤改用 Game<19>
     }
     */
     int gameTimes = 30;
@@ -26,23 +26,28 @@ int main() {
         return 1;
     }
     // 寫入 CSV 標題行
-    outputFile << "SimulationTimes,AverageTime (ms)" << endl;
-    // 模擬不同次數的情況
-    for (int simulationTimes = 1000; simulationTimes <= 10000; simulationTimes += 1000) {
-        totalTime = 0;
-        for (int i = 0; i < gameTimes; i++) {
-            Node* root = new Node();  // 創建根節點
-            // Game::generateFullTree(root);        // 生成完整遊戲樹
-            MCTS ai(simulationTimes, 6);       // 創建 MCTS AI
-            totalTime += ai.run(root, 10000);  // 執行 MCTS
-            deleteTree(root);                  // 刪除樹
+    outputFile << "SearchMode,SimulationTimes,AverageTime (ms)" << endl;
+    // 比較葉平行與根平行在不同模擬次數下的耗時
+    for (searchMode mode : {searchMode::LEAF_PARALLEL, searchMode::ROOT_PARALLEL}) {
+        for (int simulationTimes = 1000; simulationTimes <= 10000; simulationTimes += 1000) {
+            totalTime = 0;
+            for (int i = 0; i < gameTimes; i++) {
+                MCTS<DEFAULT_BOARD_SIZE> ai(simulationTimes, 6, mode);  // 創建 MCTS AI
+                Node<DEFAULT_BOARD_SIZE>* root = ai.createRoot();       // 創建根節點，整棵樹隨 ai 一起釋放
+                // Game::generateFullTree(root);        // 生成完整遊戲樹
+                // 空棋盤沒有與棋子相鄰的候選點，先下天元與一手應手，兩種模式才會真的拓展並跑 playout
+                root = ai.advanceRoot(root, {DEFAULT_BOARD_SIZE / 2, DEFAULT_BOARD_SIZE / 2});
+                root = ai.advanceRoot(root, {DEFAULT_BOARD_SIZE / 2, DEFAULT_BOARD_SIZE / 2 + 1});
+                totalTime += ai.run(root, 10000);  // 執行 MCTS
+            }
+            // 計算平均時間
+            double average_time = totalTime / static_cast<double>(gameTimes);
+            // 輸出到 CSV 檔案
+            outputFile << mode << "," << simulationTimes << "," << average_time << endl;
+            // 同時輸出到控制台（可選）
+            cout << "SearchMode = " << mode << ", SimulationTimes = " << simulationTimes
+                 << ", AverageTime = " << average_time << " ms" << endl;
         }
-        // 計算平均時間
-        double average_time = totalTime / static_cast<double>(gameTimes);
-        // 輸出到 CSV 檔案
-        outputFile << simulationTimes << "," << average_time << endl;
-        // 同時輸出到控制台（可選）
-        cout << "SimulationTimes = " << simulationTimes << ", AverageTime = " << average_time << " ms" << endl;
     }
     // 關閉檔案
     outputFile.close();
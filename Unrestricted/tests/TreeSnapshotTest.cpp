@@ -0,0 +1,127 @@
+#include <stdint.h>
+
+#include <cstdio>
+#include <vector>
+
+#include "Bitboard.hpp"
+#include "Node.hpp"
+#include "TreeSnapshot.hpp"
+
+namespace {
+
+constexpr int N = 15;
+using Snapshot = TreeSnapshot<N>;
+
+int failures = 0;
+
+void expect(bool condition, const char* message) {
+    if (!condition) {
+        std::fprintf(stderr, "FAILED: %s\n", message);
+        failures++;
+    }
+}
+
+/**
+ * @brief 把快照中的節點與搜尋樹上同一局面的節點逐層比對：子節點數與著手集合都要一致
+ */
+void compare(const Snapshot& snapshot, const Snapshot::SnapshotNode* saved, const Node<N>* live) {
+    int built = live->builtChildren();
+    expect(saved->childCount == built, "快照的子節點數應等於區塊中已建立的節點數");
+    if (saved->childCount != built) {
+        return;
+    }
+    const Snapshot::SnapshotNode* children = snapshot.children(saved);
+    for (int i = 0; i < built; i++) {
+        expect(i == 0 || children[i - 1].move < children[i].move, "區塊內的著手應由小到大且不重複");
+        const Node<N>* match = nullptr;
+        for (int j = 0; j < built; j++) {
+            if (Board<N>::index(live->children[j].lastMove) == children[i].move) {
+                match = &live->children[j];
+            }
+        }
+        expect(match != nullptr, "快照的子節點應對應到樹上的著手");
+        if (match != nullptr) {
+            expect(children[i].visits == match->visits.load(), "子節點的訪問次數應原樣保留");
+            compare(snapshot, &children[i], match);
+        }
+    }
+}
+
+}  // namespace
+
+/**
+ * @brief 置換表共用、且各父節點打開數量不同的子節點區塊，存檔後再讀回應與原本的樹一致
+ *
+ * 樹的形狀：根節點有 P、Q 兩個子節點，兩者共用同一個 5 格的區塊 S（前 4 格已建立、最後 1 格未打開），
+ * P 只打開了 2 格、Q 打開了 4 格；S 的第 4 個節點底下還有一個區塊 T。
+ * 廣度優先時 P 先被寫入，區塊大小若取 P 的 childCount，Q 會指到區塊之外的節點。
+ *
+ * 用法：TreeSnapshotTest [暫存快照路徑]
+ */
+int main(int argc, char** argv) {
+    const char* path = argc > 1 ? argv[1] : "TreeSnapshotTest.tree";
+
+    Node<N> root;
+    std::vector<Node<N>> top, shared, leaves;
+    top.reserve(2);
+    shared.reserve(5);
+    leaves.reserve(2);
+
+    top.emplace_back(Position{7, 7}, &root);  // P
+    top.emplace_back(Position{7, 8}, &root);  // Q
+    root.children = top.data();
+    root.candidateCount = 2;
+    root.childCount = 2;
+
+    // 依先驗分數排列，刻意與格子索引的順序相反
+    for (Position move : {Position{8, 9}, Position{8, 6}, Position{6, 9}, Position{6, 6}}) {
+        shared.emplace_back(move, &top[0]);
+    }
+    shared.emplace_back(Position{5, 5});  // 尚未打開
+    for (Node<N>& parent : top) {
+        parent.children = shared.data();
+        parent.candidateCount = 5;
+    }
+    top[0].childCount = 2;
+    top[1].childCount = 4;
+
+    leaves.emplace_back(Position{9, 9}, &shared[3]);
+    leaves.emplace_back(Position{5, 6}, &shared[3]);
+    shared[3].children = leaves.data();
+    shared[3].candidateCount = 2;
+    shared[3].childCount = 2;
+
+    int visits = 1;
+    for (std::vector<Node<N>>* block : {&top, &shared, &leaves}) {
+        for (Node<N>& node : *block) {
+            node.visits = visits++;
+        }
+    }
+    root.visits = visits;
+
+    expect(Snapshot::save(path, &root), "存檔應成功");
+    Snapshot snapshot;
+    expect(snapshot.open(path), "讀回快照應成功");
+    if (snapshot.isOpen()) {
+        expect(snapshot.size() == 1 + 2 + 4 + 2, "共用的區塊只存一份");
+        const Snapshot::SnapshotNode* saved = snapshot.find(root.hash);
+        expect(saved != nullptr, "根節點應收錄在索引中");
+        if (saved != nullptr) {
+            compare(snapshot, saved, &root);
+        }
+        // 兩個父節點都應看到整個已建立的區塊
+        for (const Node<N>& parent : top) {
+            const Snapshot::SnapshotNode* node = snapshot.find(parent.hash);
+            expect(node != nullptr && node->childCount == 4, "共用區塊的每個父節點應寫入相同的子節點數");
+        }
+        snapshot.close();
+    }
+    std::remove(path);
+
+    if (failures > 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("TreeSnapshotTest passed\n");
+    return 0;
+}
@@ -0,0 +1,87 @@
+#include <stdint.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "BatchPlayout.hpp"
+#include "Bitboard.hpp"
+#include "Game.hpp"
+#include "MCTS.hpp"
+#include "Node.hpp"
+#include "TreeSnapshot.hpp"
+
+namespace {
+
+constexpr int N = DEFAULT_BOARD_SIZE;
+constexpr const char* DEFAULT_SNAPSHOT_PATH = "analysis.tree";
+constexpr int PLAYOUTS_PER_LEAF = PLAYOUT_BATCH;
+constexpr int TOP_MOVES = 5;  ///< 輸出訪問次數前幾名的著手
+
+}  // namespace
+
+/**
+ * @brief 以搜尋樹快照暖啟動的局面分析
+ *
+ * 用法：Analyze [快照路徑] [思考毫秒數] [著手 x,y ...]
+ * 依序下完給定的著手（沒有給時為天元）後搜尋，結束時把整棵樹寫回快照；
+ * 下一次分析同一局面或其後續局面時會接著既有的統計繼續搜尋，而不是從頭來過。
+ */
+int main(int argc, char** argv) {
+    const char* path = argc > 1 ? argv[1] : DEFAULT_SNAPSHOT_PATH;
+    int milliseconds = argc > 2 ? std::max(1, atoi(argv[2])) : 1000;
+    std::vector<Position> moves;
+    for (int i = 3; i < argc; i++) {
+        Position move;
+        if (sscanf(argv[i], "%d,%d", &move.x, &move.y) != 2 || move.x < 0 || move.x >= N || move.y < 0 ||
+            move.y >= N) {
+            std::cerr << "Error: Invalid move " << argv[i] << std::endl;
+            return 1;
+        }
+        moves.push_back(move);
+    }
+    if (moves.empty()) {
+        moves.push_back({N / 2, N / 2});  // 空棋盤沒有候選點可以搜尋
+    }
+
+    TreeSnapshot<N> snapshot;
+    if (snapshot.open(path)) {
+        std::cout << "Loaded search tree snapshot with " << snapshot.size() << " nodes" << std::endl;
+    }
+    const int threadCount = std::max(1u, std::thread::hardware_concurrency());
+    MCTS<N> ai(PLAYOUTS_PER_LEAF, threadCount, searchMode::TREE_PARALLEL);
+    ai.setSnapshot(&snapshot);
+    Node<N>* root = ai.createRoot();
+    for (const Position& move : moves) {
+        root = ai.advanceRoot(root, move);
+    }
+    if (root->isWin) {
+        std::cout << "The game is already over" << std::endl;
+        return 0;
+    }
+    int startVisits = root->visits;
+    int iterations = ai.runFor(root, milliseconds);
+    std::cout << "visits " << startVisits << " -> " << root->visits << " (" << iterations << " this run)" << std::endl;
+
+    std::vector<Node<N>*> children;
+    for (int i = 0; i < root->childCount; i++) {
+        children.push_back(&root->children[i]);
+    }
+    std::sort(children.begin(), children.end(), [](Node<N>* a, Node<N>* b) { return a->visits > b->visits; });
+    for (int i = 0; i < TOP_MOVES && i < static_cast<int>(children.size()); i++) {
+        Node<N>* child = children[i];
+        double winRate = child->visits > 0 ? child->wins / child->visits : 0.0;
+        std::cout << child->lastMove.x << "," << child->lastMove.y << "  visits " << child->visits << "  value "
+                  << winRate << std::endl;
+    }
+
+    if (!TreeSnapshot<N>::save(path, root, &snapshot)) {
+        std::cerr << "Error: Unable to write " << path << "!" << std::endl;
+        return 1;
+    }
+    std::cout << "Saved search tree to " << path << std::endl;
+    return 0;
+}
@@ -0,0 +1,103 @@
+#include <stdint.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "BatchPlayout.hpp"
+#include "Bitboard.hpp"
+#include "Game.hpp"
+#include "MCTS.hpp"
+#include "Node.hpp"
+#include "OpeningBook.hpp"
+
+namespace {
+
+constexpr int N = DEFAULT_BOARD_SIZE;
+constexpr uint64_t BUILD_SEED = 20240601;  ///< 固定種子：根平行搜尋在同樣的參數與執行緒數下建出同樣的開局庫
+constexpr int PLAYOUTS_PER_LEAF = PLAYOUT_BATCH;
+
+struct Options {
+    const char* output = DEFAULT_BOOK_PATH;
+    int plies = 6;           ///< 收錄到棋盤上有幾顆棋子為止的局面
+    int width = 3;           ///< 每個局面往下展開訪問次數最多的幾個著手
+    int iterations = 20000;  ///< 每個局面的 MCTS iteration 數
+};
+
+}  // namespace
+
+/**
+ * @brief 以離線 MCTS 建立開局庫
+ *
+ * 用法：BuildBook [輸出路徑] [手數] [分支數] [每個局面的 iteration 數]
+ * 從天元開始逐層搜尋：每個局面跑一次 MCTS，記下訪問次數最多的著手，再沿訪問次數前幾名的著手往下展開。
+ * 對稱的局面以標準形雜湊去除重複，只搜尋一次。
+ */
+int main(int argc, char** argv) {
+    Options options;
+    if (argc > 1) options.output = argv[1];
+    if (argc > 2) options.plies = std::max(1, atoi(argv[2]));
+    if (argc > 3) options.width = std::max(1, atoi(argv[3]));
+    if (argc > 4) options.iterations = std::max(1, atoi(argv[4]));
+    const int threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    std::vector<OpeningBook<N>::BookEntry> entries;
+    std::unordered_set<uint64_t> seen;
+    // 空棋盤沒有候選點可搜尋，第一手固定下天元（天元在所有對稱下不變，標準形座標相同）
+    const Position center = {N / 2, N / 2};
+    {
+        Node<N> empty;
+        int symmetry;
+        uint64_t key = OpeningBook<N>::canonicalKey(empty.boardBlack, empty.boardWhite, &symmetry);
+        entries.push_back({key, 0, static_cast<uint16_t>(Board<N>::index(center)), 0});
+        seen.insert(key);
+    }
+
+    std::vector<std::vector<Position>> frontier = {{center}};
+    for (int ply = 1; ply < options.plies && !frontier.empty(); ply++) {
+        std::vector<std::vector<Position>> next;
+        for (const std::vector<Position>& line : frontier) {
+            // 根平行在相同種子與執行緒數下逐位元可重現，樹平行的執行緒交錯則取決於排程
+            MCTS<N> ai(PLAYOUTS_PER_LEAF, threadCount, searchMode::ROOT_PARALLEL);
+            ai.setSeed(BUILD_SEED);
+            Node<N>* node = ai.createRoot();
+            for (const Position& move : line) {
+                node = ai.advanceRoot(node, move);
+            }
+            int symmetry;
+            uint64_t key = OpeningBook<N>::canonicalKey(node->boardBlack, node->boardWhite, &symmetry);
+            if (node->isWin || !seen.insert(key).second) continue;
+
+            ai.run(node, options.iterations);
+            Node<N>* best = ai.bestChild(node);
+            double winRate = best->visits > 0 ? best->wins / best->visits : 0.0;
+            // 著手轉成標準形座標保存，查詢時再轉回實際局面的座標
+            int move = OpeningBook<N>::transform(Board<N>::index(best->lastMove), symmetry);
+            entries.push_back({key, static_cast<uint32_t>(best->visits), static_cast<uint16_t>(move),
+                               static_cast<int16_t>(winRate * 10000)});
+
+            std::vector<Node<N>*> children;
+            for (int i = 0; i < node->childCount; i++) {
+                children.push_back(&node->children[i]);
+            }
+            std::sort(children.begin(), children.end(), [](Node<N>* a, Node<N>* b) { return a->visits > b->visits; });
+            for (int i = 0; i < options.width && i < static_cast<int>(children.size()); i++) {
+                std::vector<Position> extended = line;
+                extended.push_back(children[i]->lastMove);
+                next.push_back(extended);
+            }
+        }
+        std::cout << "ply " << ply << ": " << entries.size() << " positions" << std::endl;
+        frontier = std::move(next);
+    }
+
+    if (!OpeningBook<N>::write(options.output, entries)) {
+        std::cerr << "Error: Unable to write opening book!" << std::endl;
+        return 1;
+    }
+    std::cout << "wrote " << entries.size() << " positions to " << options.output << std::endl;
+    return 0;
+}
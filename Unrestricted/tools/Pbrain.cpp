@@ -0,0 +1,13 @@
+#include <iostream>
+
+#include "Piskvork.hpp"
+
+/**
+ * @brief Gomocup / Piskvork 比賽用的引擎執行檔（比賽規定執行檔名稱以 pbrain- 開頭）
+ *
+ * 由管理程式經標準輸入輸出傳送協定指令，不會輸出任何互動提示。
+ */
+int main() {
+    std::ios::sync_with_stdio(false);
+    return runPiskvork(std::cin, std::cout);
+}
@@ -0,0 +1,59 @@
+#include <stdint.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+#include "Game.hpp"
+#include "GameRecord.hpp"
+#include "SelfPlay.hpp"
+
+namespace {
+
+constexpr int N = DEFAULT_BOARD_SIZE;
+constexpr const char* DEFAULT_RECORD_PATH = "selfplay.rec";
+
+}  // namespace
+
+/**
+ * @brief 不經過互動介面的平行自我對弈，產生訓練與調參用的棋譜
+ *
+ * 用法：SelfPlay [輸出路徑] [盤數] [每步 iteration 數] [同時進行的盤數] [種子]
+ * 紀錄以附加模式寫入，重複執行會接在既有的棋譜後面（換一個種子才不會產生相同的對局）。
+ */
+int main(int argc, char** argv) {
+    const char* output = DEFAULT_RECORD_PATH;
+    SelfPlayOptions options;
+    if (argc > 1) output = argv[1];
+    if (argc > 2) options.games = std::max(1, atoi(argv[2]));
+    if (argc > 3) options.iterations = std::max(1, atoi(argv[3]));
+    if (argc > 4) options.workers = std::max(0, atoi(argv[4]));
+    if (argc > 5) options.seed = strtoull(argv[5], nullptr, 10);
+
+    GameRecord::Writer writer;
+    if (!writer.open(output)) {
+        std::cerr << "Error: Unable to open " << output << "!" << std::endl;
+        return 1;
+    }
+    auto start = std::chrono::steady_clock::now();
+    int written = SelfPlay<N>(options).run(writer);
+    writer.close();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "played " << written << " games in " << seconds << " s" << std::endl;
+
+    GameRecord::Reader reader;
+    if (!reader.open(output)) {
+        std::cerr << "Error: Unable to read back " << output << "!" << std::endl;
+        return 1;
+    }
+    size_t positions = 0;
+    int results[3] = {0, 0, 0};  // 白勝、平手、黑勝
+    size_t records = reader.forEach([&](const GameRecord::RecordHeader& header, const unsigned char*) {
+        positions += header.moveCount;
+        results[header.winner + 1]++;
+    });
+    std::cout << output << ": " << records << " games, " << positions << " positions (black " << results[2]
+              << ", white " << results[0] << ", draw " << results[1] << ")" << std::endl;
+    return 0;
+}